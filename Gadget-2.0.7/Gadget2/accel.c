@@ -7,6 +7,9 @@
 #include "allvars.h"
 #include "proto.h"
 
+extern void pi_region_enter(int);
+extern void pi_region_exit(int);
+
 /*! \file accel.c
  *  \brief driver routine to carry out force computation
  */
@@ -35,13 +38,16 @@ void compute_accelerations(int mode)
   if(All.PM_Ti_endstep == All.Ti_Current)
     {
       tstart = second();
+      pi_region_enter(PI_REGION_PM);
       long_range_force();
+      pi_region_exit(PI_REGION_PM);
       tend = second();
       All.CPU_PM += timediff(tstart, tend);
     }
 #endif
 
   tstart = second();		/* measure the time for the full force computation */
+  pi_region_enter(PI_REGION_GRAVITY);
 
   gravity_tree();		/* computes gravity accel. */
 
@@ -50,6 +56,7 @@ void compute_accelerations(int mode)
 				 * to allow usage of relative opening
 				 * criterion for consistent accuracy.
 				 */
+  pi_region_exit(PI_REGION_GRAVITY);
   tend = second();
   All.CPU_Gravity += timediff(tstart, tend);
 
@@ -66,7 +73,9 @@ void compute_accelerations(int mode)
 	}
 
       tstart = second();
+      pi_region_enter(PI_REGION_DENSITY);
       density();		/* computes density, and pressure */
+      pi_region_exit(PI_REGION_DENSITY);
       tend = second();
       All.CPU_Hydro += timediff(tstart, tend);
 
@@ -83,7 +92,9 @@ void compute_accelerations(int mode)
 	}
 
       tstart = second();
+      pi_region_enter(PI_REGION_HYDRO);
       hydro_force();		/* adds hydrodynamical accelerations and computes viscous entropy injection  */
+      pi_region_exit(PI_REGION_HYDRO);
       tend = second();
       All.CPU_Hydro += timediff(tstart, tend);
     }
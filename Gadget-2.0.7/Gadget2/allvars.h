@@ -46,6 +46,13 @@ typedef  long long  peanokey;    /*!< defines the variable type used for Peano-H
 
 #define  MAXLEN_FILENAME  100    /*!< Maximum number of characters for filenames (including the full path) */
 
+#define  PI_REGION_DOMAIN   0    /*!< regions timed by the Paramount Iterations library */
+#define  PI_REGION_PM       1
+#define  PI_REGION_GRAVITY  2
+#define  PI_REGION_DENSITY  3
+#define  PI_REGION_HYDRO    4
+#define  PI_REGION_IO       5
+
 #ifdef   ISOTHERM_EQS
 #define  GAMMA         (1.0)     /*!< index for isothermal gas */
 #else
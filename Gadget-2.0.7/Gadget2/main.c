@@ -9,6 +9,7 @@
 
 extern void init_timestep_();
 extern void exit_timestep_();
+extern void pi_region_define(int, const char *);
 
 /*! \file main.c
  *  \brief start of the program
@@ -30,6 +31,12 @@ int main(int argc, char **argv)
   MPI_Comm_size(MPI_COMM_WORLD, &NTask);
 
   init_timestep_();
+  pi_region_define(PI_REGION_DOMAIN, "domain_Decomposition");
+  pi_region_define(PI_REGION_PM, "long_range_force");
+  pi_region_define(PI_REGION_GRAVITY, "gravity_tree");
+  pi_region_define(PI_REGION_DENSITY, "density");
+  pi_region_define(PI_REGION_HYDRO, "hydro_force");
+  pi_region_define(PI_REGION_IO, "savepositions");
 
   if(NTask <= 1)
     {
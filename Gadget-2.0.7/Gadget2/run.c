@@ -11,6 +11,9 @@
 extern void begin_timestep_();
 extern void end_timestep_();
 extern void after_timestep_();
+extern void set_progress_(double*);
+extern void pi_region_enter(int);
+extern void pi_region_exit(int);
 
 /*! \file run.c
  *  \brief  iterates over timesteps, main loop
@@ -27,6 +30,8 @@ void run(void)
   int stopflag = 0;
   char stopfname[200], contfname[200];
   double t0, t1;
+  double pi_progress;
+  int pi_ti_begin = All.Ti_Current;
 
 
   sprintf(stopfname, "%sstop", All.OutputDir);
@@ -43,10 +48,19 @@ void run(void)
 					 * at the desired time.
 					 */
 
+      /* fraction of the way to TimeMax reached by this step, for the runtime projection */
+      if(pi_ti_begin < TIMEBASE)
+	{
+	  pi_progress = (double) (All.Ti_Current - pi_ti_begin) / (TIMEBASE - pi_ti_begin);
+	  set_progress_(&pi_progress);
+	}
+
       every_timestep_stuff();	/* write some info to log-files */
 
 
+      pi_region_enter(PI_REGION_DOMAIN);
       domain_Decomposition();	/* do domain decomposition if needed */
+      pi_region_exit(PI_REGION_DOMAIN);
 
 
       compute_accelerations(0);	/* compute accelerations for 
@@ -227,7 +241,9 @@ void find_next_sync_point_and_drift(void)
       domain_Decomposition();
       compute_potential();
 #endif
+      pi_region_enter(PI_REGION_IO);
       savepositions(All.SnapshotFileCount++);	/* write snapshot file */
+      pi_region_exit(PI_REGION_IO);
 
       All.Ti_nextoutput = find_next_outputtime(All.Ti_nextoutput + 1);
     }
@@ -35,6 +35,13 @@ extern void init_timestep_();
 extern void begin_timestep_();
 extern void end_timestep_();
 extern void exit_timestep_();
+extern void set_total_iterations_(int*);
+extern void pi_region_define(int, const char*);
+extern void pi_region_enter(int);
+extern void pi_region_exit(int);
+
+#define PI_REGION_BFS 0
+#define PI_REGION_VALIDATE 1
 
 static int compare_doubles(const void* a, const void* b) {
 	double aa = *(const double*)a;
@@ -73,6 +80,8 @@ void get_statistics(const double x[], int n, volatile double r[s_LAST]) {
 
 int main(int argc, char** argv) {
   init_timestep_();
+  pi_region_define(PI_REGION_BFS, "run_bfs");
+  pi_region_define(PI_REGION_VALIDATE, "validate_result");
 	aml_init(&argc,&argv); //includes MPI_Init inside
 	setup_globals();
 
@@ -359,6 +368,7 @@ int main(int argc, char** argv) {
 			validate_result(1,&tg, nlocalverts, bfs_roots[0], pred,shortest,NULL);
 		}
 
+		set_total_iterations_(&num_bfs_roots);
 		for (bfs_root_idx = 0; bfs_root_idx < num_bfs_roots; ++bfs_root_idx) {
       begin_timestep_();
 			int64_t root = bfs_roots[bfs_root_idx];
@@ -368,7 +378,9 @@ int main(int argc, char** argv) {
 			clean_pred(&pred[0]); //user-provided function from bfs_implementation.c
 			/* Do the actual BFS. */
 			double bfs_start = MPI_Wtime();
+			pi_region_enter(PI_REGION_BFS);
 			run_bfs(root, &pred[0]);
+			pi_region_exit(PI_REGION_BFS);
 			double bfs_stop = MPI_Wtime();
 			bfs_times[bfs_root_idx] = bfs_stop - bfs_start;
 			if (rank == 0) fprintf(stderr, "Time for BFS %d is %f\n", bfs_root_idx, bfs_times[bfs_root_idx]);
@@ -382,7 +394,9 @@ int main(int argc, char** argv) {
 				if (rank == 0) fprintf(stderr, "Validating BFS %d\n", bfs_root_idx);
 
 				double validate_start = MPI_Wtime();
+				pi_region_enter(PI_REGION_VALIDATE);
 				int validation_passed_one = validate_result(1,&tg, nlocalverts, root, pred,shortest,&edge_visit_count);
+				pi_region_exit(PI_REGION_VALIDATE);
 				double validate_stop = MPI_Wtime();
 
 				validate_times[bfs_root_idx] = validate_stop - validate_start;
@@ -7,6 +7,9 @@
 #ifndef BACKEND_H
 #define BACKEND_H
 
+// PI library regions, named once per process by BackEnd::init
+#define PI_REGION_COMPUTE  0
+
 /*  Base class for providing an API to a front end interface.  */
 
 class BackEnd {
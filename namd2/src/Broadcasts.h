@@ -56,6 +56,7 @@ enum {
   traceBarrierTag,
   accelMDRescaleFactorTag,
   adaptTemperatureTag, //Tag for adaptive tempering temperature updates to Sequencer
+  pairlistMaxAgeTag,
 #ifdef MEASURE_NAMD_WITH_PAPI
   papiMeasureTag,
 #endif
@@ -84,6 +85,7 @@ struct ControllerBroadcasts
   SimpleBroadcastObject<int> traceBarrier;
   SimpleBroadcastObject<Vector> accelMDRescaleFactor;
   SimpleBroadcastObject<BigReal> adaptTemperature;
+  SimpleBroadcastObject<int> pairlistMaxAge;
 #ifdef MEASURE_NAMD_WITH_PAPI
   SimpleBroadcastObject<int> papiMeasureBarrier;
 #endif
@@ -106,6 +108,7 @@ struct ControllerBroadcasts
 #endif
     accelMDRescaleFactor(accelMDRescaleFactorTag, ldObjPtr),
     adaptTemperature(adaptTemperatureTag, ldObjPtr),
+    pairlistMaxAge(pairlistMaxAgeTag, ldObjPtr),
     scriptBarrier(scriptBarrierTag, ldObjPtr),
 #ifdef MEASURE_NAMD_WITH_PAPI
 	papiMeasureBarrier(papiMeasureTag, ldObjPtr),
@@ -21,6 +21,7 @@ enum ComputeType
 {
   computeNonbondedSelfType,
   computeNonbondedPairType,
+  computeNonbondedShellType,
   computeNonbondedCUDAType,
   computeNonbondedMICType,
   computeExclsType,
@@ -493,8 +493,14 @@ void ComputeNonbondedUtil :: NAME
   const CompAtom *p_1 = params->p[1];
   KNL( const CompAtomFlt *pFlt_0 = params->pFlt[0]; )
   KNL( const CompAtomFlt *pFlt_1 = params->pFlt[1]; )
+#ifndef NAMD_KNL
+  const CompAtomSoA *pSoA_1 = params->pSoA[1];
+  const float * const q_1 = pSoA_1->q;
+  const int32 * const vdwType_1 = pSoA_1->vdwType;
+#endif
   const CompAtomExt *pExt_0 = params->pExt[0];
   const CompAtomExt *pExt_1 = params->pExt[1];
+  const CompAtomExcl *pExcl_0 = params->pExcl[0];
 
   char * excl_flags_buff = 0;
   const int32 * full_excl = 0;
@@ -694,18 +700,18 @@ void ComputeNonbondedUtil :: NAME
   NBWORKARRAY(int,pairlist,arraysize);
   NBWORKARRAY(int,pairlist2,arraysize);
   ALCH(
-  NBWORKARRAY(plint,pairlistnA1,arraysize);
-  NBWORKARRAY(plint,pairlistxA1,arraysize);
-  NBWORKARRAY(plint,pairlistmA1,arraysize);
-  NBWORKARRAY(plint,pairlistnA2,arraysize);
-  NBWORKARRAY(plint,pairlistxA2,arraysize);
-  NBWORKARRAY(plint,pairlistmA2,arraysize);
-  NBWORKARRAY(plint,pairlistnA3,arraysize);
-  NBWORKARRAY(plint,pairlistxA3,arraysize);
-  NBWORKARRAY(plint,pairlistmA3,arraysize);
-  NBWORKARRAY(plint,pairlistnA4,arraysize);
-  NBWORKARRAY(plint,pairlistxA4,arraysize);
-  NBWORKARRAY(plint,pairlistmA4,arraysize);
+  NBALCHWORKARRAY(plint,pairlistnA1,arraysize);
+  NBALCHWORKARRAY(plint,pairlistxA1,arraysize);
+  NBALCHWORKARRAY(plint,pairlistmA1,arraysize);
+  NBALCHWORKARRAY(plint,pairlistnA2,arraysize);
+  NBALCHWORKARRAY(plint,pairlistxA2,arraysize);
+  NBALCHWORKARRAY(plint,pairlistmA2,arraysize);
+  NBALCHWORKARRAY(plint,pairlistnA3,arraysize);
+  NBALCHWORKARRAY(plint,pairlistxA3,arraysize);
+  NBALCHWORKARRAY(plint,pairlistmA3,arraysize);
+  NBALCHWORKARRAY(plint,pairlistnA4,arraysize);
+  NBALCHWORKARRAY(plint,pairlistxA4,arraysize);
+  NBALCHWORKARRAY(plint,pairlistmA4,arraysize);
   )
 
   int fixg_upper = 0;
@@ -848,42 +854,46 @@ void ComputeNonbondedUtil :: NAME
 
   if ( savePairlists || ! usePairlists ) {
 
-    #ifdef MEM_OPT_VERSION
-    const ExclusionCheck *exclcheck = mol->get_excl_check_for_idx(pExt_i.exclId);        
-    const int excl_min = pExt_i.id + exclcheck->min;
-    const int excl_max = pExt_i.id + exclcheck->max;
-    #else
-    const ExclusionCheck *exclcheck = mol->get_excl_check_for_atom(pExt_i.id);
-    const int excl_min = exclcheck->min;
-    const int excl_max = exclcheck->max;
-    #endif
-    const char * excl_flags_var;
-    if ( exclcheck->flags ) excl_flags_var = exclcheck->flags - excl_min;
-    else {  // need to build list on the fly
-
-    //TODO: Should change later!!!!!!!!!! --Chao Mei
-    //Now just for the sake of passing compilation
-    #ifndef MEM_OPT_VERSION 
-      if ( excl_flags_buff ) {
-        int nl,l;
-        nl = full_excl[0] + 1;
-        for ( l=1; l<nl; ++l ) excl_flags_buff[full_excl[l]] = 0;
-        nl = mod_excl[0] + 1;
-        for ( l=1; l<nl; ++l ) excl_flags_buff[mod_excl[l]] = 0;
-      } else {
-        excl_flags_buff = new char[mol->numAtoms];
-        memset( (void*) excl_flags_buff, 0, mol->numAtoms);
-      }
-      int nl,l;
-      full_excl = mol->get_full_exclusions_for_atom(pExt_i.id);
-      nl = full_excl[0] + 1;
-      for ( l=1; l<nl; ++l ) excl_flags_buff[full_excl[l]] = EXCHCK_FULL;
-      mod_excl = mol->get_mod_exclusions_for_atom(pExt_i.id);
-      nl = mod_excl[0] + 1;
-      for ( l=1; l<nl; ++l ) excl_flags_buff[mod_excl[l]] = EXCHCK_MOD;
-      excl_flags_var = excl_flags_buff;
-    #endif
+    // exclusions of i come from the bitmasks of the patch unless they
+    // span too many atoms, then from the ExclusionCheck of the molecule
+    const CompAtomExcl &excl_i = pExcl_0[i];
+    const int excl_min = excl_i.min;
+    const int excl_max = excl_i.max;
+    const int excl_wide = excl_i.wide();
+    const char * excl_flags_var = 0;
+    if ( excl_wide ) {
+      #ifdef MEM_OPT_VERSION
+      const ExclusionCheck *exclcheck = mol->get_excl_check_for_idx(pExt_i.exclId);        
+      #else
+      const ExclusionCheck *exclcheck = mol->get_excl_check_for_atom(pExt_i.id);
+      #endif
+      if ( exclcheck->flags ) excl_flags_var = exclcheck->flags - excl_min;
+      else {  // need to build list on the fly
+
+        //TODO: Should change later!!!!!!!!!! --Chao Mei
+        //Now just for the sake of passing compilation
+        #ifndef MEM_OPT_VERSION 
+          if ( excl_flags_buff ) {
+            int nl,l;
+            nl = full_excl[0] + 1;
+            for ( l=1; l<nl; ++l ) excl_flags_buff[full_excl[l]] = 0;
+            nl = mod_excl[0] + 1;
+            for ( l=1; l<nl; ++l ) excl_flags_buff[mod_excl[l]] = 0;
+          } else {
+            excl_flags_buff = new char[mol->numAtoms];
+            memset( (void*) excl_flags_buff, 0, mol->numAtoms);
+          }
+          int nl,l;
+          full_excl = mol->get_full_exclusions_for_atom(pExt_i.id);
+          nl = full_excl[0] + 1;
+          for ( l=1; l<nl; ++l ) excl_flags_buff[full_excl[l]] = EXCHCK_FULL;
+          mod_excl = mol->get_mod_exclusions_for_atom(pExt_i.id);
+          nl = mod_excl[0] + 1;
+          for ( l=1; l<nl; ++l ) excl_flags_buff[mod_excl[l]] = EXCHCK_MOD;
+          excl_flags_var = excl_flags_buff;
+        #endif
 
+      }
     }
     const char * const excl_flags = excl_flags_var;
 
@@ -957,75 +967,7 @@ void ComputeNonbondedUtil :: NAME
       if ( g < gu ) {
 	int hu = 0;
 #ifndef NAMD_KNL
-#if defined(__SSE2__) && ! defined(NAMD_DISABLE_SSE)
-	if ( gu - g  >  6 ) { 
-
-          #if NAMD_ComputeNonbonded_SortAtoms != 0 && ( 0 PAIR ( + 1 ) )
-	    register SortEntry* sortEntry0 = sortValues + g;
-	    register SortEntry* sortEntry1 = sortValues + g + 1;
-            register int jprev0 = sortEntry0->index;
-	    register int jprev1 = sortEntry1->index;
-          #else
-            register int jprev0 = glist[g    ];
-	    register int jprev1 = glist[g + 1];
-	  #endif
-	  
-	  register int j0;
-	  register int j1;
-
-          __m128d PJ_X_01 = _mm_set_pd(p_1[jprev1].position.x, p_1[jprev0].position.x);
-          __m128d PJ_Y_01 = _mm_set_pd(p_1[jprev1].position.y, p_1[jprev0].position.y);
-          __m128d PJ_Z_01 = _mm_set_pd(p_1[jprev1].position.z, p_1[jprev0].position.z);
-
-          // these don't change here, so we could move them into outer scope
-          const __m128d P_I_X = _mm_set1_pd(p_i_x);
-          const __m128d P_I_Y = _mm_set1_pd(p_i_y);
-          const __m128d P_I_Z = _mm_set1_pd(p_i_z);
- 
-	  g += 2;
-	  for ( ; g < gu - 2; g +=2 ) {
-	    // compute 1d distance, 2-way parallel	 
-	    j0     =  jprev0;
-	    j1     =  jprev1;
-
-            __m128d T_01 = _mm_sub_pd(P_I_X, PJ_X_01);
-            __m128d R2_01 = _mm_mul_pd(T_01, T_01);
-            T_01 = _mm_sub_pd(P_I_Y, PJ_Y_01);
-            R2_01 = _mm_add_pd(R2_01, _mm_mul_pd(T_01, T_01));
-            T_01 = _mm_sub_pd(P_I_Z, PJ_Z_01);
-            R2_01 = _mm_add_pd(R2_01, _mm_mul_pd(T_01, T_01));
-	    
-            #if NAMD_ComputeNonbonded_SortAtoms != 0 && ( 0 PAIR ( + 1 ) )
-	      sortEntry0 = sortValues + g;
-	      sortEntry1 = sortValues + g + 1;
-              jprev0 = sortEntry0->index;
-	      jprev1 = sortEntry1->index;
-            #else
-	      jprev0     =  glist[g  ];
-	      jprev1     =  glist[g+1];
-	    #endif
-	   
-            PJ_X_01 = _mm_set_pd(p_1[jprev1].position.x, p_1[jprev0].position.x);
-            PJ_Y_01 = _mm_set_pd(p_1[jprev1].position.y, p_1[jprev0].position.y);
-            PJ_Z_01 = _mm_set_pd(p_1[jprev1].position.z, p_1[jprev0].position.z);
-
-            __align(16) double r2_01[2];
-            _mm_store_pd(r2_01, R2_01); // 16-byte-aligned store
-
-            // XXX these could possibly benefit from SSE-based conditionals
-	    bool test0 = ( r2_01[0] < groupplcutoff2 );
-	    bool test1 = ( r2_01[1] < groupplcutoff2 ); 
-	    
-	    //removing ifs benefits on many architectures
-	    //as the extra stores will only warm the cache up
-	    goodglist [ hu         ] = j0;
-	    goodglist [ hu + test0 ] = j1;
-	    
-	    hu += test0 + test1;
-	  }
-	  g-=2;
-	}
-#elif defined (A2_QPX)
+#if defined (A2_QPX)
 	if ( gu - g  >  6 ) { 
 #if NAMD_ComputeNonbonded_SortAtoms != 0 && ( 0 PAIR ( + 1 ) )
 	  register SortEntry* sortEntry0 = sortValues + g;
@@ -1089,82 +1031,35 @@ void ComputeNonbondedUtil :: NAME
 #else
 	if ( gu - g  >  6 ) { 
 
+	  // Screen groups on the single precision copy of patch 1, relative
+	  // to its center.  Coordinates within 100 A of the center round to
+	  // 6e-6 A, so r2 is off by less than 3e-3 A^2 for pairlist distances
+	  // up to 30 A; the 0.01 A^2 margin covers that, and the few extra
+	  // groups are dropped again by the cutoff test on each step.
+	  const float * const x_1 = pSoA_1->x;
+	  const float * const y_1 = pSoA_1->y;
+	  const float * const z_1 = pSoA_1->z;
+	  const float p_i_x_s = p_i_x - pSoA_1->center.x;
+	  const float p_i_y_s = p_i_y - pSoA_1->center.y;
+	  const float p_i_z_s = p_i_z - pSoA_1->center.z;
+	  const float groupplcutoff2_s = groupplcutoff2 + 0.01;
+
+	  for ( ; g < gu; ++g ) {
           #if NAMD_ComputeNonbonded_SortAtoms != 0 && ( 0 PAIR ( + 1 ) )
-	    register SortEntry* sortEntry0 = sortValues + g;
-	    register SortEntry* sortEntry1 = sortValues + g + 1;
-            register int jprev0 = sortEntry0->index;
-	    register int jprev1 = sortEntry1->index;
+	    const int j = sortValues[g].index;
           #else
-            register int jprev0 = glist[g    ];
-	    register int jprev1 = glist[g + 1];
+	    const int j = glist[g];
 	  #endif
-	  
-	  register  int j0; 
-	  register  int j1; 
-	  
-	  register  BigReal pj_x_0, pj_x_1; 
-	  register  BigReal pj_y_0, pj_y_1; 
-	  register  BigReal pj_z_0, pj_z_1; 
-	  register  BigReal t_0, t_1, r2_0, r2_1;
-	  
-	  pj_x_0 = p_1[jprev0].position.x;
-	  pj_x_1 = p_1[jprev1].position.x;  
-	  
-	  pj_y_0 = p_1[jprev0].position.y; 
-	  pj_y_1 = p_1[jprev1].position.y;  
-	  
-	  pj_z_0 = p_1[jprev0].position.z; 
-	  pj_z_1 = p_1[jprev1].position.z;
-	  
-	  g += 2;
-	  for ( ; g < gu - 2; g +=2 ) {
-	    // compute 1d distance, 2-way parallel	 
-	    j0     =  jprev0;
-	    j1     =  jprev1;
-	    
-	    t_0    =  p_i_x - pj_x_0;
-	    t_1    =  p_i_x - pj_x_1;
-	    r2_0   =  t_0 * t_0;
-	    r2_1   =  t_1 * t_1;
-	    
-	    t_0    =  p_i_y - pj_y_0;
-	    t_1    =  p_i_y - pj_y_1;
-	    r2_0  +=  t_0 * t_0;
-	    r2_1  +=  t_1 * t_1;
-	    
-	    t_0    =  p_i_z - pj_z_0;
-	    t_1    =  p_i_z - pj_z_1;
-	    r2_0  +=  t_0 * t_0;
-	    r2_1  +=  t_1 * t_1;
-	    
-            #if NAMD_ComputeNonbonded_SortAtoms != 0 && ( 0 PAIR ( + 1 ) )
-	      sortEntry0 = sortValues + g;
-	      sortEntry1 = sortValues + g + 1;
-              jprev0 = sortEntry0->index;
-	      jprev1 = sortEntry1->index;
-            #else
-	      jprev0     =  glist[g  ];
-	      jprev1     =  glist[g+1];
-	    #endif
-	    
-	    pj_x_0     =  p_1[jprev0].position.x;
-	    pj_x_1     =  p_1[jprev1].position.x;
-	    pj_y_0     =  p_1[jprev0].position.y; 
-	    pj_y_1     =  p_1[jprev1].position.y;
-	    pj_z_0     =  p_1[jprev0].position.z; 
-	    pj_z_1     =  p_1[jprev1].position.z;
-	    
-	    bool test0 = ( r2_0 < groupplcutoff2 );
-	    bool test1 = ( r2_1 < groupplcutoff2 ); 
-	    
+	    const float t_x = p_i_x_s - x_1[j];
+	    const float t_y = p_i_y_s - y_1[j];
+	    const float t_z = p_i_z_s - z_1[j];
+	    const float r2 = t_x * t_x + t_y * t_y + t_z * t_z;
+
 	    //removing ifs benefits on many architectures
 	    //as the extra stores will only warm the cache up
-	    goodglist [ hu         ] = j0;
-	    goodglist [ hu + test0 ] = j1;
-	    
-	    hu += test0 + test1;
+	    goodglist [ hu ] = j;
+	    hu += ( r2 < groupplcutoff2_s );
 	  }
-	  g-=2;
 	}
 #endif
 #endif // NAMD_KNL
@@ -1613,7 +1508,7 @@ void ComputeNonbondedUtil :: NAME
     for (k=0; k < npair2; ++k ) {
       int j = pairlist2[k];
       int atom2 = pExt_1[j].id;
-      int excl_flag = excl_flags[atom2];
+      int excl_flag = ( excl_wide ? excl_flags[atom2] : excl_i.flag(atom2) );
       ALCH(int pswitch = pswitchTable[p_i_partition + 5*(p_1[j].partition)];)
       switch ( excl_flag ALCH( + 3 * pswitch)) {
       case 0:  *(plin++) = j;  break;
@@ -1693,6 +1588,7 @@ void ComputeNonbondedUtil :: NAME
   } else { // if ( savePairlists || ! usePairlists )
 	// PAIR( iout << i << " " << i_upper << " use\n" << endi;)
 
+    pairlists.nextatom();
     pairlists.nextlist(&pairlistn_save,&npairn);  --npairn;
     pairlists.nextlist(&pairlistx_save,&npairx);  --npairx;
     pairlists.nextlist(&pairlistm_save,&npairm);  --npairm;
@@ -103,7 +103,11 @@ MODIFIED(
 #if  ( FAST( 1 + ) TABENERGY( 1 + ) 0 ) // FAST or TABENERGY
       //const LJTable::TableEntry * lj_pars = 
       //        lj_row + 2 * p_j->vdwType MODIFIED(+ 1);
+#ifdef NAMD_KNL
       const int lj_index = 2 * p_j->vdwType MODIFIED(+ 1);
+#else
+      const int lj_index = 2 * vdwType_1[j] MODIFIED(+ 1);
+#endif
 #define lj_pars (lj_row+lj_index)
 #ifdef  A2_QPX
       double *lj_pars_d = (double *) lj_pars;
@@ -176,7 +180,11 @@ MODIFIED(
       }
       */
 
+#ifdef NAMD_KNL
       BigReal kqq = kq_i * p_j->charge;
+#else
+      BigReal kqq = kq_i * q_1[j];
+#endif
 
       
 #ifdef  A2_QPX
@@ -0,0 +1,91 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Cluster-pair nonbonded kernel.  Consecutive atoms of a patch are
+   grouped into clusters of NBCLUSTER_SIZE atoms and interact tile by
+   tile, one SIMD vector of j atoms per i atom.
+*/
+
+#ifndef COMPUTENONBONDEDCLUSTER_H
+#define COMPUTENONBONDEDCLUSTER_H
+
+#include "ComputeNonbondedUtil.h"
+
+// The cluster size follows the double precision SIMD width.  KNL builds
+// keep float LJ table entries and use the portable loops.
+#if defined(__AVX512F__) && ! defined(NAMD_DISABLE_SSE) && ! defined(NAMD_KNL)
+#define NBCLUSTER_AVX512
+#define NBCLUSTER_SIZE 8
+#elif defined(__AVX2__) && ! defined(NAMD_DISABLE_SSE) && ! defined(NAMD_KNL)
+#define NBCLUSTER_AVX2
+#define NBCLUSTER_SIZE 4
+#else
+#define NBCLUSTER_SIZE 4
+#endif
+
+// Tile masks hold bit ( ii * NBCLUSTER_SIZE + jj ) for atom pair (ii,jj).
+typedef unsigned long long nbcluster_mask;
+
+// A pairlist entry is the j cluster followed by its excluded and
+// modified masks, stored as plint words.
+#define NBCLUSTER_MASK_WORDS ( NBCLUSTER_SIZE * NBCLUSTER_SIZE / 16 )
+#define NBCLUSTER_ENTRY_SIZE ( 1 + 2 * NBCLUSTER_MASK_WORDS )
+
+// Staged atoms of one patch: SoA coordinates relative to the same origin
+// as the i patch, padded to whole clusters with copies of the last atom.
+struct nbcluster_patch {
+  int numAtoms;
+  int numClusters;
+  int stride;             // padded number of atoms
+  BigReal *x, *y, *z, *q;
+  int *type;
+  BigReal *f;             // x, y and z blocks of stride entries
+  BigReal *fullf;
+  BigReal *bounds;        // center and half extent, 6 per cluster
+  float *xf, *yf, *zf, *qf;  // nonbondedMixedPrecision, relative to the
+                             // center of the i patch
+};
+
+// BigReal entries of work array needed to stage a patch, kept a multiple
+// of 8 so that every block stays 64-byte aligned.
+#define NBCLUSTER_PATCH_DATA(NCL) \
+  ( ( 10 * NBCLUSTER_SIZE * (NCL) + 6 * (NCL) + 7 ) & ~7 )
+
+// float entries of work array for the single precision copy of a patch
+#define NBCLUSTER_MIXED_DATA(NCL) \
+  ( ( 4 * NBCLUSTER_SIZE * (NCL) + 15 ) & ~15 )
+
+inline int nbcluster_count(int numAtoms) {
+  return ( numAtoms + NBCLUSTER_SIZE - 1 ) / NBCLUSTER_SIZE;
+}
+
+inline int nbcluster_first_bit(nbcluster_mask m) {
+#if defined(__GNUC__)
+  return __builtin_ctzll(m);
+#else
+  int b = 0;
+  while ( ! ( m & 1 ) ) { m >>= 1; ++b; }
+  return b;
+#endif
+}
+
+inline void nbcluster_put_mask(plint *list, nbcluster_mask m) {
+  for ( int w = 0; w < NBCLUSTER_MASK_WORDS; ++w ) {
+    list[w] = (plint) ( m >> ( 16 * w ) );
+  }
+}
+
+inline nbcluster_mask nbcluster_get_mask(const plint *list) {
+  nbcluster_mask m = 0;
+  for ( int w = 0; w < NBCLUSTER_MASK_WORDS; ++w ) {
+    m |= ( (nbcluster_mask) list[w] ) << ( 16 * w );
+  }
+  return m;
+}
+
+#endif // COMPUTENONBONDEDCLUSTER_H
+
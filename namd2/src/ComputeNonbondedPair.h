@@ -23,6 +23,7 @@ public:
 protected :
   virtual void initialize();
   virtual int noWork();
+  virtual void doWork();
   virtual void doForce(CompAtom* p[2], CompAtomExt* pExt[2], Results* r[2]);
   Box<Patch,CompAtom> *avgPositionBox[2];
   // BEGIN LA
@@ -45,9 +46,10 @@ protected :
 
   ComputeNonbondedWorkArrays* const workArrays;
 
-  Pairlists pairlists;
+  Pairlists *pairlists;  // one per chunk of pmeOverlapChunks
   int pairlistsValid;
   BigReal pairlistTolerance;
+  int overlapChunk;
 
   int minPart, maxPart, numParts;
 
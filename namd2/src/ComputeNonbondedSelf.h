@@ -24,6 +24,7 @@ public:
 protected :
   virtual void initialize();
   virtual int noWork();
+  virtual void doWork();
   virtual void doForce(CompAtom* p, CompAtomExt* pExt, Results* r);
   Box<Patch,CompAtom> *avgPositionBox;
   // BEGIN LA
@@ -45,9 +46,10 @@ protected :
 
   ComputeNonbondedWorkArrays* const workArrays;
 
-  Pairlists pairlists;
+  Pairlists *pairlists;  // one per chunk of pmeOverlapChunks
   int pairlistsValid;
   BigReal pairlistTolerance;
+  int overlapChunk;
 
 
   int minPart, maxPart, numParts;
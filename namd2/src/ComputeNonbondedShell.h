@@ -0,0 +1,87 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Nonbonded interactions of a home patch with itself and with the
+   downstream patches of its half shell, evaluated by one compute object
+   in place of a ComputeNonbondedSelf and one ComputeNonbondedPair per
+   neighbor.  Each distinct patch is checked out once per step.
+*/
+
+#ifndef COMPUTENONBONDEDSHELL_H
+#define COMPUTENONBONDEDSHELL_H
+
+#include "Compute.h"
+#include "PatchTypes.h"
+#include "Box.h"
+#include "OwnerBox.h"
+#include "ComputeMap.h"
+#include "ComputeNonbondedUtil.h"
+
+class Patch;
+
+class ComputeNonbondedShell : public Compute, private ComputeNonbondedUtil {
+
+public:
+  // pid[0] is the home patch and pid[1..numPids-1] the patches it
+  // interacts with; the home patch itself with trans 13 is the self part
+  ComputeNonbondedShell(ComputeID c, int numPids, PatchID pid[], int trans[],
+	ComputeNonbondedWorkArrays* _workArrays,
+	int minPartition = 0, int maxPartition = 1, int numPartitions = 1);
+  virtual ~ComputeNonbondedShell();
+  nonbonded params;
+
+  virtual void initialize();
+  virtual void atomUpdate();
+  virtual int noWork();
+  virtual void doWork();
+
+protected :
+  enum { maxPids = ComputeMap::numPidsAllocated };
+
+  void doForce();
+  void doSelf(int k);
+  void doPair(int k);
+
+  int numPids;
+  PatchID patchID[maxPids];
+  int trans[maxPids];
+  int slot[maxPids];      // distinct patch of each pid
+
+  // one entry per distinct patch
+  int numSlots;
+  int first[maxPids];      // first pid of the patch
+  Patch *patch[maxPids];
+  Box<Patch,CompAtom> *positionBox[maxPids];
+  Box<Patch,Results> *forceBox[maxPids];
+  CompAtom *p[maxPids];
+  CompAtomExt *pExt[maxPids];
+  Results *r[maxPids];
+  int numAtoms[maxPids];
+  // DMK - Atom Separation (water vs. non-water)
+  #if NAMD_SeparateWaters != 0
+    int numWaterAtoms[maxPids];
+  #endif
+
+  BigReal reductionData[reductionDataSize];
+  SubmitReduction *reduction;
+  SubmitReduction *pressureProfileReduction;
+  BigReal *pressureProfileData;
+
+  ComputeNonbondedWorkArrays* const workArrays;
+
+  // one entry per interaction, indexed like the pids
+  Pairlists pairlists[maxPids];
+  int pairlistsValid[maxPids];
+  BigReal pairlistTolerance[maxPids];
+
+  int minPart, maxPart, numParts;
+  int overlapChunk;  // interactions are split into pmeOverlapChunks
+
+};
+
+#endif
+
@@ -14,6 +14,7 @@
 #include "NamdTypes.h"
 #include "ReductionMgr.h"
 #include "Molecule.h"
+#include "memusage.h"
 
 class LJTable;
 class Molecule;
@@ -32,59 +33,159 @@ void unregister_mic_compute(ComputeID c);
 
 typedef unsigned short plint;
 
+// With setCompressed() the lists are kept as zigzag varint deltas and
+// only the lists of the current atom are expanded into data.  Saving an
+// atom starts with newlist(max_size), reading one back with nextatom(),
+// and its lists stay valid until the next atom is started.
 class Pairlists {
   enum {initsize = 10};
   plint *data;
   int curpos;
   int size;
+  unsigned char *bytes;  // compressed lists and index values
+  int bytepos;
+  int bytesize;
+  int compressed;
   Pairlists(const Pairlists&) { ; }
   Pairlists& operator=(const Pairlists&) { return *this; }
-public:
-  Pairlists() : size(initsize) { data = new plint[initsize]; }
-  ~Pairlists() { delete [] data; }
-  plint *newlist(int max_size) {  // get a new list w/ room for max_size
-    int reqnewsize = curpos + max_size + 1;
+
+  void growdata(int reqnewsize, int keep) {
     int newsize = size;
     while ( newsize < reqnewsize ) { newsize += newsize >> 1; }
     if ( newsize > size ) {
       plint *newdata = new plint[newsize];
-      CmiMemcpy(newdata,data,curpos*sizeof(plint));
+      CmiMemcpy(newdata,data,keep*sizeof(plint));
       delete [] data;
       data = newdata;
+      memusage_pairlists_add((long)(newsize-size)*sizeof(plint));
       size = newsize;
     }
+  }
+  void growbytes(int reqnewsize) {
+    int newsize = bytesize ? bytesize : initsize;
+    while ( newsize < reqnewsize ) { newsize += newsize >> 1; }
+    if ( newsize > bytesize ) {
+      unsigned char *newbytes = new unsigned char[newsize];
+      if ( bytepos ) CmiMemcpy(newbytes,bytes,bytepos);
+      delete [] bytes;
+      bytes = newbytes;
+      memusage_pairlists_add(newsize-bytesize);
+      bytesize = newsize;
+    }
+  }
+public:
+  Pairlists() : size(initsize), bytes(0), bytepos(0), bytesize(0),
+		compressed(0) {
+    data = new plint[initsize];
+    memusage_pairlists_add(initsize*sizeof(plint));
+  }
+  ~Pairlists() {
+    memusage_pairlists_add(-(long)(size*sizeof(plint)+bytesize));
+    delete [] data;
+    delete [] bytes;
+  }
+  void setCompressed(int on) {  // before any list is saved
+    compressed = on;
+    reset();
+  }
+  plint *newlist(int max_size) {  // get a new list w/ room for max_size
+    if ( compressed ) {
+      curpos = 0;
+      growdata(max_size,0);
+      return data;
+    }
+    growdata(curpos + max_size + 1, curpos);
     return &data[curpos+1];
   }
 
   // don't specify size if previous allocation should have extra space
   plint *newlist() {  // get a new list assuming already allocated
-    return &data[curpos+1];
+    return compressed ? &data[curpos] : &data[curpos+1];
   }
 
   void newsize(int list_size) {  // set the size of the last list gotten
+    if ( compressed ) {
+      growbytes(bytepos + 5 + 3 * list_size);
+      unsigned char *b = bytes + bytepos;
+      unsigned int v = list_size;
+      for ( ; v >= 0x80; v >>= 7 ) *(b++) = v | 0x80;
+      *(b++) = v;
+      plint prev = 0;
+      for ( int k = curpos; k < curpos + list_size; ++k ) {
+        int d = (short) (plint) ( data[k] - prev );
+        prev = data[k];
+        for ( v = ( (unsigned int) d << 1 ) ^ ( d >> 31 ); v >= 0x80; v >>= 7 )
+          *(b++) = v | 0x80;
+        *(b++) = v;
+      }
+      bytepos = b - bytes;
+      curpos += list_size;
+      return;
+    }
     data[curpos] = list_size;
     curpos += list_size + 1;
   }
-  void reset() { curpos = 0; }  // go back to the beginning
+  void reset() { curpos = 0; bytepos = 0; }  // go back to the beginning
+  void nextatom() {  // start reading back the lists of the next atom
+    if ( compressed ) curpos = 0;
+  }
   void nextlist(plint **list, int *list_size) {  // get next list and size
+    if ( compressed ) {
+      const unsigned char *b = bytes + bytepos;
+      unsigned int v = 0;
+      int shift = 0;
+      do { v |= (unsigned int) ( *b & 0x7f ) << shift; shift += 7; }
+      while ( *(b++) & 0x80 );
+      const int n = v;
+      if ( curpos + n > size ) NAMD_bug("Pairlists::nextlist overflow");
+      plint prev = 0;
+      for ( int k = curpos; k < curpos + n; ++k ) {
+        v = 0;  shift = 0;
+        do { v |= (unsigned int) ( *b & 0x7f ) << shift; shift += 7; }
+        while ( *(b++) & 0x80 );
+        data[k] = prev = (plint) ( prev + ( (int) ( v >> 1 ) ^ -(int) ( v & 1 ) ) );
+      }
+      bytepos = b - bytes;
+      *list = &data[curpos];
+      curpos += ( *list_size = n );
+      return;
+    }
     *list = &data[curpos+1];
     curpos += ( *list_size = data[curpos] ) + 1;
   }
   int getSize() { return size; }
 
   void addIndex() {  // assume space for index already allocated
+    if ( compressed ) { growbytes(bytepos + 2);  bytepos += 2;  return; }
     curpos++;
   }
   void setIndexValue(plint i) {  // assume no newsize since addIndex
+    if ( compressed ) {
+      bytes[bytepos-2] = i & 0xff;
+      bytes[bytepos-1] = i >> 8;
+      return;
+    }
     data[curpos-1] = i;
   }
 
   plint getIndexValue() {
+    if ( compressed ) {
+      bytepos += 2;
+      return bytes[bytepos-2] | ( bytes[bytepos-1] << 8 );
+    }
     return data[curpos++];
   }
 
 };
 
+// define splitting function
+#define SPLIT_NONE	1
+#define SPLIT_SHIFT	2
+#define SPLIT_C1	3
+#define SPLIT_XPLOR	4
+#define SPLIT_C2	5
+#define SPLIT_MARTINI	6
+
 #define NBWORKARRAYSINIT(ARRAYS) \
   ComputeNonbondedWorkArrays* const computeNonbondedWorkArrays = ARRAYS;
 
@@ -99,8 +200,40 @@ public:
   TYPE * const NAME = computeNonbondedWorkArrays->NAME.begin();
 #endif
 
+#ifdef __INTEL_COMPILER
+#define NBALCHWORKARRAY(TYPE,NAME,SIZE) \
+  computeNonbondedWorkArrays->alch->NAME.resize(SIZE); \
+  TYPE * const NAME = computeNonbondedWorkArrays->alch->NAME.begin(); \
+  __assume_aligned(NAME,64);
+#else
+#define NBALCHWORKARRAY(TYPE,NAME,SIZE) \
+  computeNonbondedWorkArrays->alch->NAME.resize(SIZE); \
+  TYPE * const NAME = computeNonbondedWorkArrays->alch->NAME.begin();
+#endif
+
+class ComputeNonbondedAlchWorkArrays {
+public:
+  // n = normal, x = excluded, m = modified
+  // A[1-4] = alchemical partition 1-4
+  ResizeArray<plint> pairlistnA1;
+  ResizeArray<plint> pairlistxA1;
+  ResizeArray<plint> pairlistmA1;
+  ResizeArray<plint> pairlistnA2;
+  ResizeArray<plint> pairlistxA2;
+  ResizeArray<plint> pairlistmA2;
+  ResizeArray<plint> pairlistnA3;
+  ResizeArray<plint> pairlistxA3;
+  ResizeArray<plint> pairlistmA3;
+  ResizeArray<plint> pairlistnA4;
+  ResizeArray<plint> pairlistxA4;
+  ResizeArray<plint> pairlistmA4;
+};
+
 class ComputeNonbondedWorkArrays {
 public:
+  ComputeNonbondedWorkArrays() : alch(0) { }
+  ~ComputeNonbondedWorkArrays() { delete alch; }
+
   ResizeArray<int> pairlisti;
   ResizeArray<BigReal> r2list;
 #ifdef NAMD_KNL
@@ -131,27 +264,18 @@ public:
   ResizeArray<plint> pairlistx;
   ResizeArray<plint> pairlistm;
 
-  // n = normal, x = excluded, m = modified
-  // A[1-4] = alchemical partition 1-4
-  ResizeArray<plint> pairlistnAlch;
-  ResizeArray<plint> pairlistnA0;
-  ResizeArray<plint> pairlistnA1;
-  ResizeArray<plint> pairlistxA1;
-  ResizeArray<plint> pairlistmA1;
-  ResizeArray<plint> pairlistnA2;
-  ResizeArray<plint> pairlistxA2;
-  ResizeArray<plint> pairlistmA2;
-  ResizeArray<plint> pairlistnA3;
-  ResizeArray<plint> pairlistxA3;
-  ResizeArray<plint> pairlistmA3;
-  ResizeArray<plint> pairlistnA4;
-  ResizeArray<plint> pairlistxA4;
-  ResizeArray<plint> pairlistmA4;
+  // only allocated when FEP or TI is enabled
+  ComputeNonbondedAlchWorkArrays *alch;
   
   ResizeArray<int> pairlist;
   ResizeArray<int> pairlist2;
   ResizeArray<Force> f_0;
   ResizeArray<Force> fullf_0;
+
+  // cluster-pair kernel staging
+  ResizeArray<BigReal> clusterData;
+  ResizeArray<int> clusterTypes;
+  ResizeArray<float> clusterMixed;
 };
 
 //struct sent to CalcGBIS
@@ -192,8 +316,11 @@ struct nonbonded {
   CompAtom* p[2];
 #ifdef NAMD_KNL
   CompAtomFlt *pFlt[2];
+#else
+  const CompAtomSoA *pSoA[2];
 #endif
   CompAtomExt *pExt[2];
+  const CompAtomExcl *pExcl[2];
   // BEGIN LA
   CompAtom* v[2];
   // END LA
@@ -284,6 +411,8 @@ public:
   static void submitPressureProfileData(BigReal*,SubmitReduction*);
 
   static Bool commOnly;
+  static Bool pairlistCompression;
+  static int pmeOverlapChunks;  // see ComputeNonbondedSelf::doWork()
   static Bool fixedAtomsOn;
   static Bool qmForcesOn ;
   static BigReal cutoff;
@@ -309,6 +438,13 @@ public:
   static BigReal *vdwb_table;
   static BigReal *r2_table;
   static int table_length;
+  // single precision copies for nonbondedMixedPrecision
+  static float *mixed_table_alloc;
+  static float *mixed_table_short;
+  static float *mixed_table_noshort;
+  static float *mixed_slow_table;
+  static float *mixed_r2_table;
+  static float *mixed_lj_table;
   #if defined(NAMD_MIC)
     static BigReal *mic_table_base_ptr; // DMK - NOTE : Duplicate but, use so that nothing breaks if the ordering of sub-arrays changes
     static int mic_table_n;
@@ -538,6 +674,26 @@ public:
   static void calc_self_slow_fullelect_go(nonbonded *);
   static void calc_self_energy_slow_fullelect_go(nonbonded *);
 
+  //cluster-pair kernel
+  static void analytic_setup(const SimParameters *simParams,
+                             int splitType, BigReal r2_limit);
+  static void calc_pair_cluster(nonbonded *);
+  static void calc_pair_energy_cluster(nonbonded *);
+  static void calc_pair_fullelect_cluster(nonbonded *);
+  static void calc_pair_energy_fullelect_cluster(nonbonded *);
+  static void calc_pair_merge_fullelect_cluster(nonbonded *);
+  static void calc_pair_energy_merge_fullelect_cluster(nonbonded *);
+  static void calc_pair_slow_fullelect_cluster(nonbonded *);
+  static void calc_pair_energy_slow_fullelect_cluster(nonbonded *);
+  static void calc_self_cluster(nonbonded *);
+  static void calc_self_energy_cluster(nonbonded *);
+  static void calc_self_fullelect_cluster(nonbonded *);
+  static void calc_self_energy_fullelect_cluster(nonbonded *);
+  static void calc_self_merge_fullelect_cluster(nonbonded *);
+  static void calc_self_energy_merge_fullelect_cluster(nonbonded *);
+  static void calc_self_slow_fullelect_cluster(nonbonded *);
+  static void calc_self_energy_slow_fullelect_cluster(nonbonded *);
+
   void calcGBIS(nonbonded *params, GBISParamStruct *gbisParams);
 };
 
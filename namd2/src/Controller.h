@@ -162,6 +162,15 @@ protected:
       BigReal heat;
       /**< heat exchanged with the thermostat since firstTimestep */
       BigReal totalEnergy0; /**< totalEnergy at firstTimestep */
+      /** Least squares sums of TOTAL3 against step for outputEnergyDrift,
+          relative to the first sample of the run. */
+      int energyDriftCount;
+      int energyDriftStep0;
+      BigReal energyDrift0;
+      BigReal energyDriftSums[4];
+      int energyDriftWarned;  /**< energyDriftLimit exceeded this run */
+      int energyDriftSlope(BigReal &perNs);
+      void printEnergyDrift(void);
       // BigReal smooth2_avg;
       BigReal smooth2_avg2;  // avoid internal compiler error
       Tensor pressure;
@@ -192,6 +201,24 @@ protected:
     int stochRescale_count;
     /**< Count time steps until next stochastic velocity rescaling. */ 
 
+    /**
+     * With pairlistAutoTune, measures the wall time of each cycle and
+     * walks the pairlist lifetime towards the fastest one that stays
+     * within the pairlistdist buffer, broadcasting it to the patches.
+     */
+    void pairlistAutoTune(int);
+    int pairlistMaxAge;
+    int pairlistTuneBest;
+    int pairlistTuneDirection;
+    int pairlistTuneReversals;
+    int pairlistTuneHold;
+    BigReal pairlistTuneBestTime;
+    BigReal pairlistTuneStartTime;
+    BigReal pairlistTuneWarnings;
+    BigReal pairlistTuneDrift;
+    BigReal pairlistTuneTolerance;
+    BigReal pairlistTunePatches;
+
     BigReal stochRescaleTimefactor;
     /**< The timefactor for stochastic velocity rescaling depends on
      * fixed configuration parameters, so can be precomputed. */
@@ -382,6 +382,16 @@ public:
   std::vector<RattleParam> rattleParam;
   std::vector<int> noconstList;
 
+  // Groups whose constraints all bind the mother atom, batched by number
+  // of constraints for rattleStar_SOA with their rma, dsq and rmb rows
+  enum { maxRattleStar = 4 };
+  std::vector<int> rattleStarList[maxRattleStar];
+  std::vector<BigReal> rattleStarParam[maxRattleStar];
+
+  // structure of arrays scratch for settle1_SOA and rattleStar_SOA
+  std::vector<BigReal> constraintSOA;
+  std::vector<int> constraintFlags;
+
   bool rattleListValid;
 
   // Array to store new positions and velocities. Allocated in "buildRattleList" to size numAtoms
@@ -489,14 +499,19 @@ protected:
   void doGroupSizeCheck();
   void doMarginCheck();
   void doAtomMigration();
+  void sortAtomsSpatially();
   int inMigration;
   int numMlBuf;
+  int numMigrations;  // for spatialSortFreq
   MigrateAtomsMsg *msgbuf[PatchMap::MaxOneAway];
   
 private:
   // Store of Atom-wise variables
   FullAtomList  atom;
   ForceList f_saved[Results::maxNumForces];
+  // slow forces of the last two full electrostatics steps for
+  // MTSAlgorithm extrapolate, the older one empty after migration
+  ForceList f_slow_last, f_slow_prev;
   ExtForce *replacementForces;
 
   CudaAtomList cudaAtomList;
@@ -66,6 +66,19 @@ struct CompAtomFlt {
 };
 #endif
 
+#ifndef NAMD_KNL
+// Structure-of-arrays copy of the CompAtom fields read by the CPU
+// nonbonded kernels.  Positions are relative to the patch center so that
+// single precision is sufficient for screening; every array is padded to
+// a multiple of 16 entries and starts on a 64-byte boundary.
+struct CompAtomSoA {
+  int numAtoms;
+  Vector center;
+  float *x, *y, *z, *q;
+  int32 *vdwType;
+};
+#endif
+
 //CompAtomExt is now needed even in normal case
 //for changing the packed msg type related to
 //ProxyPatch into varsize msg type where
@@ -97,6 +110,23 @@ struct CompAtomExt {
   unsigned int groupFixed : 1;
 };
 
+// Exclusions of one atom for the CPU nonbonded kernels, rebuilt by the
+// patch when atoms migrate.  Bit k of full and mod marks atom id min + k
+// as fully excluded or modified.  Atoms whose exclusions span 64 or more
+// ids are wide and keep using the ExclusionCheck of the Molecule.
+struct CompAtomExcl {
+  int32 min;
+  int32 max;
+  unsigned long long full;
+  unsigned long long mod;
+  int wide() const { return max - min >= 64; }
+  // 0, EXCHCK_FULL or EXCHCK_MOD for atom id, which must be within range
+  int flag(int id) const {
+    const int k = id - min;
+    return (int) ( ( full >> k ) & 1 ) | (int) ( ( ( mod >> k ) & 1 ) << 1 );
+  }
+};
+
 struct FullAtom : CompAtom, CompAtomExt{
   Velocity velocity;
   Position fixedPosition;
@@ -162,6 +192,7 @@ struct CudaForce {
 typedef ResizeArray<CudaAtom> CudaAtomList;
 typedef ResizeArray<CompAtom> CompAtomList;
 typedef ResizeArray<CompAtomExt> CompAtomExtList;
+typedef ResizeArray<CompAtomExcl> CompAtomExclList;
 #ifdef NAMD_KNL
 typedef ResizeArray<CompAtomFlt> CompAtomFltList;
 #endif
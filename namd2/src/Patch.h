@@ -114,8 +114,11 @@ class Patch
      int getNumComputes() { return positionComputeList.size(); }
 
      CompAtomExt* getCompAtomExtInfo() { return pExt.begin(); }
+     const CompAtomExcl* getCompAtomExcl() { return pExcl.begin(); }
 #ifdef NAMD_KNL
      CompAtomFlt* getCompAtomFlt() { return pFlt.begin(); }
+#else
+     const CompAtomSoA* getCompAtomSoA() { return &soa; }
 #endif
      CudaAtom* getCudaAtomList() { return cudaAtomPtr; }
 
@@ -168,8 +171,16 @@ class Patch
      #endif
 
      CompAtomExtList pExt;
+     CompAtomExclList pExcl;
+#ifndef NAMD_CUDA
+     void buildExclusionMasks();
+#endif
 #ifdef NAMD_KNL
      CompAtomFltList pFlt;
+#else
+     ResizeArray<float> soaData;
+     ResizeArray<int32> soaType;
+     CompAtomSoA soa;
 #endif
 
 #ifdef REMOVE_PROXYDATAMSG_EXTRACOPY
@@ -11,8 +11,18 @@
 #include "Vector.h"
 #include "ResizeArray.h"
 
+// Atoms per block of B-spline weights, one SIMD vector of floats.
+// Weights are stored as M[block][3*order][PME_SPLINE_BLOCK].
+#if defined(__AVX512F__)
+#define PME_SPLINE_BLOCK 16
+#elif defined(__AVX__)
+#define PME_SPLINE_BLOCK 8
+#else
+#define PME_SPLINE_BLOCK 4
+#endif
+
 class PmeRealSpace {
-  
+
 public:
   PmeRealSpace(PmeGrid grid);
   ~PmeRealSpace();
@@ -20,31 +30,45 @@ public:
   void set_num_atoms(int natoms);
 
   void fill_charges(float **q_arr, float **q_arr_list, int &q_arr_count,
-                       int &stray_count, char *f_arr, char *fz_arr, PmeParticle p[]); 
-  void compute_forces(const float * const *q_arr, const PmeParticle p[], 
+                       int &stray_count, char *f_arr, char *fz_arr, PmeParticle p[]);
+  void compute_forces(const float * const *q_arr, const PmeParticle p[],
+                      Vector f[]);
+
+  // forces on the atoms of blocks first through last
+  void compute_forces_partial(int first, int last, const float * const *q_arr, const PmeParticle p[],
                       Vector f[]);
-                      
-  void compute_forces_order4_partial(int first, int last, const float * const *q_arr, const PmeParticle p[], 
-                      Vector f[]);                      
 private:
-  void fill_charges_order4(float **q_arr, float **q_arr_list, int &q_arr_count,
-                       int &stray_count, char *f_arr, char *fz_arr, PmeParticle p[]); 
   template <int order>
   void fill_charges_order(float **q_arr, float **q_arr_list, int &q_arr_count,
-                       int &stray_count, char *f_arr, char *fz_arr, PmeParticle p[]); 
-  void compute_forces_order4(const float * const *q_arr, const PmeParticle p[], 
-                      Vector f[]);
+                       int &stray_count, char *f_arr, char *fz_arr, PmeParticle p[]);
   template <int order>
-  void compute_forces_order(const float * const *q_arr, const PmeParticle p[], 
+  void compute_forces_order(const float * const *q_arr, const PmeParticle p[],
                       Vector f[]);
+  template <int order>
+  void compute_forces_blocks(int first, int last, const float * const *q_arr,
+                      const PmeParticle p[], Vector f[]);
   template <int order> void fill_b_spline(PmeParticle p[]);
 
+  // The stencils of all atoms are spread into and gathered from a
+  // contiguous brick of grid lines, wrapped onto q_arr afterwards.
+  int brick_init(const PmeParticle p[]);
+  void brick_load(const float * const *q_arr);
+
   const PmeGrid myGrid;
   int N;
+  int numBlocks;
   float *M, *dM;
   ResizeArray<float> M_alloc, dM_alloc;
+
+  int brickValid;
+  int brickX0, brickY0, brickZ0;   // grid indices of brick origin
+  int brickNX, brickNY, brickNZ;
+  float *brick;
+  ResizeArray<float> brick_alloc;
+  ResizeArray<int> brickHits;      // stencil rows spread per brick line
+  ResizeArray<int> brickOffset;    // stencil corner of each atom
+  ResizeArray<char> brickOcc;
 };
 
 
 #endif
-
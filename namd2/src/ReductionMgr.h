@@ -154,6 +154,9 @@ typedef enum
 #endif
   REDUCTION_MARGIN_VIOLATIONS,
   REDUCTION_PAIRLIST_WARNINGS,
+  REDUCTION_PAIRLIST_DRIFT,      // pairlistAutoTune, sums over patches
+  REDUCTION_PAIRLIST_TOLERANCE,
+  REDUCTION_PAIRLIST_PATCHES,
   REDUCTION_STRAY_CHARGE_ERRORS,
  // semaphore (must be last)
   REDUCTION_MAX_RESERVED
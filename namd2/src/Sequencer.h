@@ -41,6 +41,7 @@ protected:
     void runComputeObjects(int migration = 1, int pairlists = 0, int pressureStep = 0);
     int pairlistsAreValid;
     int pairlistsAge;
+    int pairlistMaxAge;
 
     void calcFixVirial(Tensor& fixVirialNormal, Tensor& fixVirialNbond, Tensor& fixVirialSlow,
       Vector& fixForceNormal, Vector& fixForceNbond, Vector& fixForceSlow);
@@ -105,6 +106,9 @@ protected:
       int checkpoint_berendsenPressure_count;
     void langevinPiston(int);
       int slowFreq;
+    void extrapolateSlowForce(const int step, const int migrated);
+      int slowExtrapolation;   // MTSAlgorithm extrapolate
+      int slowExtrapStep;      // step of f_slow_last
     void newtonianVelocities(BigReal, const BigReal, const BigReal, 
                              const BigReal, const int, const int, const int);
     void langevinVelocities(BigReal);
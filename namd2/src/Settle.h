@@ -47,8 +47,21 @@ int settle1(const Vector *ref, Vector *pos, Vector *vel, BigReal invdt,
                  BigReal mOrmT, BigReal mHrmT, BigReal ra,
                  BigReal rb, BigReal rc, BigReal rra);
 
-template <int veclen>
-void settle1_SIMD(const Vector *ref, Vector *pos,
+/// waters or hydrogen groups per block of the structure of arrays
+/// kernels, one or two SIMD vectors of doubles
+#if defined(__AVX512F__)
+#define SETTLE_BLOCK 16
+#elif defined(__AVX__)
+#define SETTLE_BLOCK 8
+#else
+#define SETTLE_BLOCK 4
+#endif
+
+/// settle1 for nblocks blocks of SETTLE_BLOCK waters in structure of
+/// arrays form, see Settle.C
+void settle1_SOA(const int nblocks,
+  const BigReal * __restrict ref, BigReal * __restrict pos,
+  BigReal * __restrict vel, BigReal invdt,
   BigReal mOrmT, BigReal mHrmT, BigReal ra,
   BigReal rb, BigReal rc, BigReal rra);
 
@@ -71,6 +84,13 @@ void rattleN(const int icnt, const RattleParam* rattleParam,
   const BigReal tol2, const int maxiter,
   bool& done, bool& consFailure);
 
+/// rattle1 for blocks of SETTLE_BLOCK hydrogen groups constrained only
+/// to their mother atom, in structure of arrays form, see Settle.C
+void rattleStar_SOA(const int nblocks, const int icnt,
+  const BigReal * __restrict param, const BigReal * __restrict ref,
+  BigReal * __restrict pos, const BigReal tol2, const int maxiter,
+  int * __restrict done, int * __restrict consFailure);
+
 extern int settle2(BigReal mO, BigReal mH, const Vector *pos,
                    Vector *vel, BigReal dt, Tensor *virial); 
 #endif
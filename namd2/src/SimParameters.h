@@ -48,6 +48,7 @@ typedef int  MTSChoices;
 
 #define NAIVE		0
 #define VERLETI		1
+#define EXTRAPOLATE	2
 
 //  The following definitions are used to distinuish between multiple
 //  long-short range force splittings
@@ -176,6 +177,8 @@ public:
 	int twoAwayY;			//  half-size patches in Y dimension
 	int twoAwayZ;			//  half-size patches in Z dimension
 	int maxPatches;			//  maximum patch count
+	Bool nonbondedHalfShell;	//  one nonbonded compute per patch
+					//  and its half shell of neighbors
 	Bool ldbUnloadPME;		//  unload processors doing PME
 	Bool ldbUnloadZero;		//  unload processor 0
 	Bool ldbUnloadOne;		//  unload processor 1 
@@ -257,6 +260,18 @@ public:
 	BigReal pairlistGrow;		//  tol *= (1 + x) on trigger
 	BigReal pairlistTrigger;	//  trigger is atom > (1 - x) * tol
 	int outputPairlists;		//  print pairlist warnings this often
+	Bool pairlistAutoTune;		//  choose pairlist lifetime from
+					//  measured step times
+	Bool pairlistCompression;	//  keep pairlists as varint deltas
+
+	Bool nonbondedClusterPairs;	//  Evaluate CPU nonbonded forces on
+					//  cluster-pair tiles
+	Bool nonbondedClusterCheck;	//  Compare cluster-pair results against
+					//  the standard kernels on energy steps
+	Bool nonbondedMixedPrecision;	//  Single precision cluster-pair forces
+					//  with double precision accumulation
+	Bool nonbondedAnalytic;		//  Closed forms instead of interpolation
+					//  tables in the cluster-pair kernel
 
 	Bool constraintsOn;		//  Flag TRUE-> harmonic constraints 
 					//  active
@@ -787,6 +802,10 @@ public:
 	int PMEPencilsYLayout;		//  Y pencil layout strategy
 	int PMEPencilsXLayout;		//  X pencil layout strategy
         int PMESendOrder;		//  Message ordering strategy
+	int PMETransposeChunks;		//  Pipelined chunks of Z-Y transposes
+	int PMEOverlapChunks;		//  Nonbonded work chunks between which
+					//  PME messages are processed
+	int outputPMETimeline;		//  Steps between PME latency output
         Bool PMEOffload;		//  Offload reciprocal sum to accelerator
 
 	Bool useDPME;			//  Flag TRUE -> old DPME code
@@ -896,6 +915,11 @@ public:
 	int outputPressure;		//  Number of timesteps between pressure
 					//  tensor outputs
 
+	Bool outputEnergyDrift;		//  Print total energy drift at the end
+					//  of each run
+	BigReal energyDriftLimit;	//  Warn above this drift in
+					//  kcal/mol/ns per atom
+
 	Bool mergeCrossterms;		//  Merge crossterm energy w/ dihedrals
 
 	int firstTimestep;		//  Starting timestep.  Will be 0 unless
@@ -948,6 +972,8 @@ public:
 					// for any given atom
 	Bool outputPatchDetails;	// print number of atoms per patch
         Bool staticAtomAssignment;      // never migrate atoms
+        int spatialSortFreq;            // reorder atoms within patches
+                                        // every x cycles
         Bool replicaUniformPatchGrids;  // same patch grid size on all replicas
 
 	//
@@ -15,6 +15,8 @@ void sortAtomsForPatches(int *order, int *breaks,
                          const FullAtom *atoms, int nmgrps, int natoms,
                          int ni, int nj, int nk);
 
+void sortAtomsForLocality(int *order, const FullAtom *atoms, int nmgrps);
+
 
 #endif // SORTATOMS_H
 
@@ -146,6 +146,7 @@ public:
 
 private:
   void mapComputeNonbonded(void);
+  void mapComputeNonbondedShell(void);
   void mapComputeLCPO(void);
   void mapComputeNode(ComputeType);
   void mapComputeHomePatches(ComputeType);
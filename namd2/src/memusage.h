@@ -12,6 +12,12 @@ unsigned long memusage(const char **source = 0);
 inline double memusage_kB() { return memusage() / 1024.; }
 inline double memusage_MB() { return memusage() / 1048576.; }
 
+// bytes held by nonbonded pairlists on this PE
+void memusage_pairlists_init();
+void memusage_pairlists_add(long bytes);
+unsigned long memusage_pairlists();
+inline double memusage_pairlists_MB() { return memusage_pairlists() / 1048576.; }
+
 class memusageinit {
 public:
   memusageinit();
@@ -6,5 +6,6 @@
 #include <string.h>
 
 signed int parse_init_(char* arg1, char* arg2);
+void set_convergence_stop_(double*);
 
 #endif
@@ -29,6 +29,8 @@ OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdbool.h>
 
 #define IFSTATS_NAME_LENGTH 64
+#define IFSTATS_MAX_DEVICES 32
+#define IFSTATS_BUFFER_SIZE 8192
 
 typedef struct _ifstats_t {
    char           device[IFSTATS_NAME_LENGTH];
@@ -52,6 +54,16 @@ typedef struct _ifstats_t {
    struct _ifstats_t* next;
 } IFStats_t;
 
+typedef struct _ifsampler_t {
+   int            fd;
+   bool           delta;
+   int32_t        count;
+   int32_t        last;
+   char           buffer[IFSTATS_BUFFER_SIZE];
+   IFStats_t      stats[IFSTATS_MAX_DEVICES];
+   IFStats_t      totals[2][IFSTATS_MAX_DEVICES];
+} IFSampler_t;
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -59,6 +71,10 @@ extern "C" {
 IFStats_t* getIfStats();
 void releaseStats(IFStats_t* stats);
 
+int openIfSampler(IFSampler_t* sampler, bool delta);
+IFStats_t* sampleIfStats(IFSampler_t* sampler);
+void closeIfSampler(IFSampler_t* sampler);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,3 +1,4 @@
+
 #ifndef STOP_EARLY_H
 #define STOP_EARLY_H
 
@@ -6,6 +7,13 @@
 #include <stdio.h>
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <math.h>
+#include <limits.h>
+#include <float.h>
+#include <pthread.h>
+#include <stdatomic.h>
 #include <sys/time.h>
 #include <sys/resource.h>
 
@@ -14,23 +22,65 @@
 #define PRINT_EXIT 3
 #define PRINT_AVG 4
 #define PRINT_BETA 5
+#define PRINT_PROJECTION 6
+
+#define SUMMARY_INIT 0
+#define SUMMARY_AVG 1
+#define SUMMARY_BETA 2
+#define SUMMARY_PROJECTION 3
+#define SUMMARY_FIELDS 4
+
+#define MIN_CONVERGENCE_ITERATIONS 5
+
+#define STOP_FLAG 0
+#define STOP_COUNT 1
+#define STOP_MEAN 2
+#define STOP_M2 3
+#define STOP_FIELDS 4
+
+#define HISTORY_DEFAULT_SIZE 65536
+#define HISTORY_MAX_SIZE 1048576
+
+#define OUTPUT_TEXT 0
+#define OUTPUT_TRACE 1
 
 typedef enum {false, true} bool;
 
 #include "ifstats.h"
+#include "perf_stats.h"
+#include "pi_region.h"
+#include "pi_sampler.h"
+#include "pi_predict.h"
+#include "pi_trace.h"
+#include "pi_context.h"
 
-struct rusage *my_rusage;
-
-int stop_in = 15;
-long total_time;
-unsigned int current_iteration;
-double init_time;
-double begin_time;
-double first_begin_time;
-double end_time;
-double pi_sum;
-double pi;
-bool early_stop = false;
+/* State of one process or worker thread, see pi_context.h. */
+struct pi_context {
+  int label;
+  int rank;
+  bool worker;
+  unsigned int current_iteration;
+  double init_time;
+  double begin_time;
+  double first_begin_time;
+  double end_time;
+  double pi_sum;
+  double pi;
+  unsigned int pi_count;
+  double pi_mean;
+  double pi_m2;
+  double *pi_history;       /* the first iteration times, for the projection */
+  unsigned int history_size;
+  unsigned int history_capacity;
+  bool stopped;             /* ended by an early stop or convergence */
+  bool projected;
+  pi_prediction_t prediction;
+  struct rusage rusage;
+  IFSampler_t *network_sampler;
+  IFStats_t *network_stats;   /* last sample, NULL when it failed */
+  perf_group_t *perf_group;
+  pi_sampler_t *sampler;
+};
 
 double get_current_time();
 int get_iteration_();
@@ -39,12 +89,36 @@ void end_timestep_();
 void begin_timestep_();
 void exit_timestep_();
 void after_timestep_();
-void my_exit();
+void my_exit(pi_context_t*);
 void set_early_stop_(int*);
+void set_convergence_stop_(double*);
+void set_single_rank_();
+void set_total_iterations_(int*);
+void set_progress_(double*);
+void read_settings();
+int context_label(pi_context_t*);
+void update_pi_stats(pi_context_t*, double);
+double t_critical(unsigned int);
+bool converged(pi_context_t*);
+void merge_pi_stats(void*, void*, int*, MPI_Datatype*);
+bool setup_stop(pi_context_t*);
+void finish_stop(pi_context_t*);
 void debug_();
-void print_timestep(uint8_t, double, struct rusage*, IFStats_t*);
+void print_timestep(pi_context_t*, uint8_t, double);
 void print_resources(int, int, struct rusage*);
 void print_network(int, int, IFStats_t*);
+void print_regions(int, int);
+void print_counter_names(int, perf_group_t*);
+void print_hardware(int, int, perf_group_t*);
+void print_workers(pi_context_t*);
+void start_sampler(pi_context_t*);
+void print_samples(pi_context_t*);
+void print_samples_at_exit();
+void report_perf_status(pi_context_t*);
+void print_summary(pi_context_t*, double);
+bool project_runtime(pi_context_t*, double);
+void trace_timestep(pi_context_t*, uint8_t, double);
+void flush_trace(int);
+void flush_trace_at_exit();
 
 #endif
-
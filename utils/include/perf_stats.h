@@ -0,0 +1,29 @@
+#ifndef PERF_STATS_H
+#define PERF_STATS_H
+
+#include <stdint.h>
+
+#define PERF_MAX_EVENTS 16
+#define PERF_NAME_LENGTH 32
+#define PERF_DEFAULT_EVENTS "cycles,instructions,llc-load-misses,llc-store-misses,branch-misses"
+
+#define PERF_OK 0
+#define PERF_DENIED 1
+#define PERF_UNSUPPORTED 2
+
+typedef struct {
+  int count;
+  int leader;
+  int status;
+  int fds[PERF_MAX_EVENTS];
+  uint64_t ids[PERF_MAX_EVENTS];
+  char names[PERF_MAX_EVENTS][PERF_NAME_LENGTH];
+  uint64_t totals[PERF_MAX_EVENTS];   /* scaled counts at the last read */
+  uint64_t values[PERF_MAX_EVENTS];   /* counts between the last two reads */
+} perf_group_t;
+
+int perf_open(perf_group_t*, const char*);
+int perf_read(perf_group_t*);
+void perf_close(perf_group_t*);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef PI_CONTEXT_H
+#define PI_CONTEXT_H
+
+/*
+   Every thread that calls the timestep functions works on its own context.
+   Threads that do not bind one use the context of the process, which is the
+   one reported with the MPI rank, and the entry points ending in _ take a
+   lock around it. Worker threads (OpenMP threads, for instance) create a
+   context with a label of their own, printed in the rank column.
+*/
+typedef struct pi_context pi_context_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+pi_context_t* pi_context_create(int label);
+void pi_context_bind(pi_context_t* context);
+pi_context_t* pi_context_current();
+void pi_context_destroy(pi_context_t* context);
+
+void pi_init_timestep(pi_context_t* context);
+void pi_begin_timestep(pi_context_t* context);
+void pi_end_timestep(pi_context_t* context);
+void pi_exit_timestep(pi_context_t* context);
+int pi_get_iteration(pi_context_t* context);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
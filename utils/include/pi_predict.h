@@ -0,0 +1,23 @@
+#ifndef PI_PREDICT_H
+#define PI_PREDICT_H
+
+#define PREDICT_BATCH 5
+
+/* Projection of the runtime of a complete run from the iterations observed. */
+typedef struct {
+  unsigned int total;       /* iterations of the complete run */
+  unsigned int observed;
+  unsigned int warmup;      /* leading iterations left out of the steady mean */
+  double init;
+  double observed_time;     /* init and all the observed iterations */
+  double steady_mean;
+  double runtime;
+  double low;               /* 95% confidence bound of the runtime */
+  double high;
+  double cost_per_hour;
+} pi_prediction_t;
+
+unsigned int warmup_length(const double*, unsigned int);
+int pi_predict(pi_prediction_t*, const double*, unsigned int, unsigned int, double, double);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef PI_REGION_H
+#define PI_REGION_H
+
+#include <stdint.h>
+#include <time.h>
+
+#define REGION_MAX 32
+#define REGION_NAME_LENGTH 32
+
+typedef struct {
+  char name[REGION_NAME_LENGTH];
+  double start;
+  int depth;          /* regions may be re-entered before they are left */
+  double time;        /* spent inside the region during this iteration */
+  double total;       /* spent inside the region during the whole run */
+  uint64_t calls;     /* exits during this iteration */
+} pi_region_t;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void pi_region_define(int, const char*);
+void pi_region_enter(int);
+void pi_region_exit(int);
+void pi_region_enter_(int*);
+void pi_region_exit_(int*);
+int pi_region_count();
+pi_region_t* pi_region_get(int);
+void pi_region_reset();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
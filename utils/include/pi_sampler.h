@@ -0,0 +1,74 @@
+#ifndef PI_SAMPLER_H
+#define PI_SAMPLER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "ifstats.h"
+
+#define SAMPLER_DEFAULT_RECORDS 65536
+#define SAMPLER_STATUS_SIZE 4096
+
+/* One snapshot of the process taken by the sampler thread. */
+typedef struct {
+  double time;
+  double utime;
+  double stime;
+  int64_t maxrss;
+  int64_t minflt;
+  int64_t majflt;
+  int64_t nvcsw;
+  int64_t nivcsw;
+  int64_t vm_size;      /* kB, from /proc/self/status */
+  int64_t vm_rss;
+  int64_t vm_hwm;
+  uint64_t rx_bytes;    /* summed over all the interfaces */
+  uint64_t rx_packets;
+  uint64_t tx_bytes;
+  uint64_t tx_packets;
+} pi_sample_t;
+
+/* Iteration marks, chained when one chunk is full. */
+typedef struct pi_marks {
+  struct pi_marks *next;
+  double times[];
+} pi_marks_t;
+
+/*
+   The sampler thread fills a chunk of samples and spills every full one to
+   a file of its own. The timed thread only appends iteration marks. Both
+   streams are read back and merged once the sampler has stopped.
+*/
+typedef struct {
+  pthread_t thread;
+  atomic_int running;
+  long period;          /* nanoseconds */
+  int status_fd;
+  int network;
+  IFSampler_t network_sampler;
+  char buffer[SAMPLER_STATUS_SIZE];
+  pi_sample_t *samples; /* chunk being filled by the sampler thread */
+  size_t capacity;
+  size_t count;
+  FILE *spill;          /* full chunks, NULL when no file could be created */
+  size_t spilled;
+  unsigned long long dropped;
+  pi_marks_t *marks;
+  pi_marks_t *marks_last;
+  size_t marks_count;   /* marks in the last chunk */
+  size_t read;          /* merge state, samples returned so far */
+  pi_marks_t *marks_read;
+  size_t marks_cursor;
+  unsigned int iteration;
+} pi_sampler_t;
+
+int pi_sampler_start(pi_sampler_t*, double, size_t);
+void pi_sampler_mark(pi_sampler_t*, double);
+void pi_sampler_stop(pi_sampler_t*);
+int pi_sampler_next(pi_sampler_t*, pi_sample_t*, unsigned int*);
+void pi_sampler_release(pi_sampler_t*);
+
+#endif
@@ -0,0 +1,101 @@
+#ifndef PI_TRACE_H
+#define PI_TRACE_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/resource.h>
+
+#include "ifstats.h"
+#include "perf_stats.h"
+#include "pi_region.h"
+#include "pi_sampler.h"
+#include "pi_predict.h"
+
+#define TRACE_MAGIC 0x52544950 /* "PITR" */
+#define TRACE_VERSION 2
+#define TRACE_DEFAULT_RECORDS 65536
+#define TRACE_DEVICE_LENGTH 16
+#define TRACE_RESOURCE_FIELDS 14
+#define TRACE_NETWORK_FIELDS 16
+#define TRACE_HARDWARE_FIELDS PERF_MAX_EVENTS
+
+#define TRACE_INIT 1
+#define TRACE_STATS 2
+#define TRACE_RESOURCES 3
+#define TRACE_NETWORK 4
+#define TRACE_AVG 5
+#define TRACE_BETA 6
+#define TRACE_EXIT 7
+#define TRACE_COUNTER_NAME 8
+#define TRACE_HARDWARE 9
+#define TRACE_REGION 10
+#define TRACE_SAMPLE 11
+#define TRACE_PROJECTION 12
+
+/* Fixed-size header written once at the beginning of every per-rank file. */
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  int32_t rank;
+  uint32_t record_size;
+  uint64_t capacity;
+  uint64_t written;   /* records produced during the run */
+  uint64_t dropped;   /* oldest records overwritten by the ring */
+} trace_header_t;
+
+/* One [PI-INFO], [RU-INFO] or [NT-INFO] line, kept in binary form. */
+typedef struct {
+  uint32_t type;
+  uint32_t iteration;
+  int32_t label;      /* rank or label of the context that wrote it */
+  union {
+    struct {
+      double time;
+      double value;
+    } pi;
+    struct {
+      double utime;
+      double stime;
+      int64_t fields[TRACE_RESOURCE_FIELDS];
+    } resources;
+    struct {
+      char device[TRACE_DEVICE_LENGTH];
+      uint64_t counters[TRACE_NETWORK_FIELDS];
+    } network;
+    struct {
+      char name[PERF_NAME_LENGTH];
+    } counter;
+    struct {
+      uint64_t count;
+      uint64_t values[TRACE_HARDWARE_FIELDS];
+    } hardware;
+    struct {
+      char name[REGION_NAME_LENGTH];
+      double time;
+      uint64_t calls;
+    } region;
+    pi_sample_t sample;
+    pi_prediction_t projection;
+  } data;
+} trace_record_t;
+
+int trace_init(size_t);
+void trace_set_label(int);
+void trace_lock();
+void trace_unlock();
+trace_record_t* trace_next(uint32_t, uint32_t);
+void trace_resources(uint32_t, struct rusage*);
+void trace_network(uint32_t, IFStats_t*);
+void trace_counter_names(perf_group_t*);
+void trace_hardware(uint32_t, perf_group_t*);
+void trace_regions(uint32_t);
+void trace_sample(uint32_t, pi_sample_t*);
+int trace_flush(int, const char*);
+void trace_release();
+void trace_print_sample(FILE*, int, uint32_t, pi_sample_t*);
+void trace_print_projection(FILE*, int, pi_prediction_t*);
+void trace_print_record(FILE*, int, trace_record_t*);
+int trace_decode(const char*, FILE*);
+
+#endif
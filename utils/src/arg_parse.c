@@ -8,5 +8,10 @@ signed int parse_init_(char* arg1, char* arg2) {
     return max;
   }
 
+  if (strncmp(arg1, "-pi-tol", 7) == 0) {
+    double tolerance = strtod(arg2, NULL);
+    set_convergence_stop_(&tolerance);
+  }
+
   return -1;
 }
@@ -25,10 +25,14 @@ OR OTHER DEALINGS IN THE SOFTWARE.
 #include <stdbool.h>
 #include <errno.h>
 #include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
 
 #include "ifstats.h"
 
 static int readProcNetDevFile(char** output, int32_t* size);
+static int readSamplerBuffer(IFSampler_t* sampler);
+static int32_t parseSamplerBuffer(IFSampler_t* sampler, IFStats_t* stats);
 
 /**
    This will parse the /proc/net/dev file and build the IFStats_t
@@ -188,6 +192,201 @@ static int readProcNetDevFile(char** output, int32_t* size){
    return errno;
 }
 
+/**
+   Prepares a sampler that keeps /proc/net/dev open and parses it into
+   the preallocated arrays of the sampler, so sampleIfStats does no heap
+   allocation. In delta mode every sample reports the traffic since the
+   previous one (or since this call, for the first sample) instead of the
+   cumulative totals.
+
+   @param sampler - The sampler to initialize
+   @param delta - Whether samples should hold per-interval deltas
+   @return 0 on success, errno on error.
+*/
+int openIfSampler(IFSampler_t* sampler, bool delta){
+   memset(sampler, 0, sizeof(IFSampler_t));
+   sampler->delta = delta;
+
+   sampler->fd = open("/proc/net/dev", O_RDONLY);
+   if (sampler->fd < 0){
+      return errno;
+   }
+
+   if (delta){
+      if (readSamplerBuffer(sampler) != 0){
+         int error = errno;
+         closeIfSampler(sampler);
+         return error;
+      }
+      sampler->count = parseSamplerBuffer(sampler, sampler->totals[0]);
+   }
+
+   return 0;
+}
+
+/**
+   Takes a new sample using a sampler opened by openIfSampler.
+
+   @param sampler - The sampler to read with
+   @return A linked list of IFStats_t objects owned by the sampler, valid
+   until the next call, or NULL on error
+   @note errno will be set when returning NULL
+*/
+IFStats_t* sampleIfStats(IFSampler_t* sampler){
+   if (sampler->fd < 0){
+      errno = EBADF;
+      return NULL;
+   }
+
+   if (readSamplerBuffer(sampler) != 0){
+      return NULL;
+   }
+
+   if (!sampler->delta){
+      return parseSamplerBuffer(sampler, sampler->stats) > 0 ? sampler->stats : NULL;
+   }
+
+   //The cumulative totals alternate between the two arrays of the sampler
+   IFStats_t* previous = sampler->totals[sampler->last];
+   IFStats_t* totals = sampler->totals[1 - sampler->last];
+   int32_t count = parseSamplerBuffer(sampler, totals);
+   if (count == 0){
+      return NULL;
+   }
+
+   for (int32_t i = 0; i < count; i++){
+      IFStats_t* before = NULL;
+
+      //Interfaces normally keep their position, but they may come and go
+      if (i < sampler->count && strcmp(previous[i].device, totals[i].device) == 0){
+         before = &previous[i];
+      }
+      else {
+         for (int32_t j = 0; j < sampler->count; j++){
+            if (strcmp(previous[j].device, totals[i].device) == 0){
+               before = &previous[j];
+               break;
+            }
+         }
+      }
+
+      IFStats_t* stats = &sampler->stats[i];
+      uint64_t* currentStat = &stats->rxBytes;
+      uint64_t* totalStat = &totals[i].rxBytes;
+      uint64_t* beforeStat = before ? &before->rxBytes : NULL;
+      memcpy(stats->device, totals[i].device, IFSTATS_NAME_LENGTH);
+      for (int k = 0; k < 16; k++){
+         currentStat[k] = (beforeStat && totalStat[k] >= beforeStat[k]) ? totalStat[k] - beforeStat[k] : 0;
+      }
+      stats->next = (i + 1 < count) ? &sampler->stats[i + 1] : NULL;
+   }
+
+   sampler->last = 1 - sampler->last;
+   sampler->count = count;
+   return sampler->stats;
+}
+
+/**
+   Closes the file kept open by the sampler.
+
+   @param sampler - The sampler to close
+*/
+void closeIfSampler(IFSampler_t* sampler){
+   if (sampler->fd >= 0){
+      close(sampler->fd);
+   }
+
+   sampler->fd = -1;
+   sampler->count = 0;
+}
+
+/**
+   Helper function to re-read /proc/net/dev from the beginning into the
+   fixed buffer of the sampler. Output that does not fit is discarded.
+
+   @param sampler - The sampler holding the open file
+   @return 0 on success, errno on error.
+*/
+static int readSamplerBuffer(IFSampler_t* sampler){
+   size_t index = 0;
+
+   //proc files may hand out their text in pieces, so read until EOF
+   while (index < IFSTATS_BUFFER_SIZE - 1){
+      ssize_t got = pread(sampler->fd, sampler->buffer + index, IFSTATS_BUFFER_SIZE - 1 - index, (off_t)index);
+      if (got < 0){
+         if (errno == EINTR){
+            continue;
+         }
+         return errno;
+      }
+      if (got == 0){
+         break;
+      }
+      index += (size_t)got;
+   }
+
+   sampler->buffer[index] = '\0';
+   return 0;
+}
+
+/**
+   Helper function to parse the text in the sampler buffer into an array
+   of IFStats_t, linking the entries so they can be walked like the list
+   returned by getIfStats.
+
+   @param sampler - The sampler holding the text
+   @param stats - Array of IFSTATS_MAX_DEVICES entries to fill
+   @return The number of interfaces parsed
+*/
+static int32_t parseSamplerBuffer(IFSampler_t* sampler, IFStats_t* stats){
+   int32_t count = 0;
+   char* cursor = sampler->buffer;
+
+   //Throw away the first two lines of text
+   for (int i = 0; i < 2 && cursor; i++){
+      cursor = strchr(cursor, '\n');
+      if (cursor){
+         cursor++;
+      }
+   }
+
+   while (cursor && *cursor && count < IFSTATS_MAX_DEVICES){
+      char* colon = strchr(cursor, ':');
+      char* end = strchr(cursor, '\n');
+      if (!colon || (end && colon > end)){
+         break;
+      }
+
+      while (*cursor == ' '){
+         cursor++;
+      }
+
+      IFStats_t* current = &stats[count];
+      size_t length = (size_t)(colon - cursor);
+      if (length >= IFSTATS_NAME_LENGTH){
+         length = IFSTATS_NAME_LENGTH - 1;
+      }
+      memcpy(current->device, cursor, length);
+      current->device[length] = '\0';
+
+      cursor = colon + 1;
+      uint64_t* currentStat = &current->rxBytes;
+      for (int k = 0; k < 16; k++){
+         currentStat[k] = (uint64_t)strtoull(cursor, &cursor, 10);
+      }
+
+      current->next = NULL;
+      if (count > 0){
+         stats[count - 1].next = current;
+      }
+      count++;
+
+      cursor = end ? end + 1 : NULL;
+   }
+
+   return count;
+}
+
 #ifdef IFSTATS_TEST
 int main(int argc, char* argv[]){
    IFStats_t* stats = getIfStats();
@@ -1,10 +1,322 @@
 #include "kernel_stats.h"
 
+/* Settings shared by every context of the process */
+static int stop_in = 15;
+static bool early_stop = false;
+static bool convergence_stop = false;
+static double tolerance;
+static unsigned int min_iterations = MIN_CONVERGENCE_ITERATIONS;
+static int output_mode = OUTPUT_TEXT;
+static bool rank_summary = false;
+static bool rank_detail = true;
+static bool network_delta = false;
+static char *perf_events = NULL;
+static bool perf_events_denied = false;
+static unsigned int total_iterations = 0;
+static double progress = 0;
+static unsigned int progress_iteration = 0;
+static double cost_per_hour = 0;
+static double sampler_period = 0;
+static size_t sampler_records = 0;
+static int trace_rank = -1;
+static char *trace_dir = NULL;
+static pthread_once_t settings_once = PTHREAD_ONCE_INIT;
+
+static pi_context_t process_context = {.label = -1, .rank = -1, .worker = false};
+static pthread_mutex_t process_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread pi_context_t *current_context = NULL;
+
+/* Iterations of every context, aggregated at exit */
+static atomic_uint worker_contexts;
+static atomic_ullong worker_iterations;
+static atomic_ullong worker_pi_nsec;
+
+/* Convergence stop, agreed on by every rank on a communicator of its own */
+static bool single_rank = false;
+static MPI_Comm stop_comm = MPI_COMM_NULL;
+static MPI_Datatype stop_type = MPI_DATATYPE_NULL;
+static MPI_Op stop_op = MPI_OP_NULL;
+static MPI_Request stop_request = MPI_REQUEST_NULL;
+static double stop_local[STOP_FIELDS];
+static double stop_global[STOP_FIELDS];
+
 void set_early_stop_(int *number){
   early_stop = true;
   stop_in = *number;
 }
 
+void set_convergence_stop_(double *relative_tolerance){
+  if(*relative_tolerance > 0) {
+    convergence_stop = true;
+    tolerance = *relative_tolerance;
+  }
+}
+
+/*
+   Declares that only one rank calls the iteration hooks, like the NAMD
+   Controller, so that the ranks cannot agree on a convergence stop.
+*/
+void set_single_rank_() {
+  single_rank = true;
+}
+
+/* Number of iterations of the complete run, used to project its runtime. */
+void set_total_iterations_(int *number) {
+  if(*number > 0)
+    total_iterations = *number;
+}
+
+/*
+   Fraction of the complete run reached at the end of the current iteration,
+   for applications whose iteration count is not known in advance.
+*/
+void set_progress_(double *fraction) {
+  if(*fraction > 0 && *fraction <= 1) {
+    progress = *fraction;
+    progress_iteration = pi_context_current()->current_iteration;
+  }
+}
+
+void read_settings() {
+  char *mode = getenv("PI_OUTPUT");
+  char *records = getenv("PI_TRACE_RECORDS");
+  char *delta = getenv("PI_NET_DELTA");
+  char *relative_tolerance = getenv("PI_TOLERANCE");
+  char *minimum = getenv("PI_MIN_ITERATIONS");
+  char *summary = getenv("PI_SUMMARY");
+  char *detail = getenv("PI_RANK_DETAIL");
+  char *period = getenv("PI_SAMPLER_PERIOD");
+  char *samples = getenv("PI_SAMPLER_RECORDS");
+  char *total = getenv("PI_TOTAL_ITERATIONS");
+  char *cost = getenv("PI_COST_PER_HOUR");
+
+  if(relative_tolerance != NULL && !convergence_stop) {
+    double value = atof(relative_tolerance);
+    set_convergence_stop_(&value);
+  }
+  if(minimum != NULL && atoi(minimum) > 0)
+    min_iterations = atoi(minimum);
+
+  rank_summary = summary != NULL && atoi(summary) != 0;
+  rank_detail = detail == NULL || atoi(detail) != 0;
+  network_delta = delta != NULL && atoi(delta) != 0;
+  perf_events = getenv("PI_PERF_EVENTS");
+
+  if(total != NULL && atoi(total) > 0)
+    total_iterations = atoi(total);
+  if(cost != NULL)
+    cost_per_hour = atof(cost);
+
+  if(period != NULL && atof(period) > 0) {
+    sampler_period = atof(period);
+    sampler_records = samples ? strtoul(samples, NULL, 10) : 0;
+  }
+
+  if(mode != NULL && strcmp(mode, "trace") == 0) {
+    trace_dir = getenv("PI_TRACE_DIR");
+    if(trace_init(records ? strtoul(records, NULL, 10) : 0) == 0) {
+      output_mode = OUTPUT_TRACE;
+      atexit(flush_trace_at_exit);
+    }else {
+      fprintf(stderr, "[PI-WARN] Could not allocate trace buffer, using text output\n");
+    }
+  }
+}
+
+pi_context_t* pi_context_create(int label) {
+  pi_context_t *context = (pi_context_t*) calloc(1, sizeof(pi_context_t));
+
+  if(context == NULL)
+    return NULL;
+
+  context->label = label;
+  context->rank = -1;
+  context->worker = true;
+
+  return context;
+}
+
+void pi_context_bind(pi_context_t *context) {
+  current_context = context;
+}
+
+/* Threads that never bound a context share the one of the process. */
+pi_context_t* pi_context_current() {
+  if(current_context == NULL)
+    current_context = &process_context;
+
+  return current_context;
+}
+
+void pi_context_destroy(pi_context_t *context) {
+  if(context == NULL || context == &process_context)
+    return;
+
+  if(current_context == context)
+    current_context = NULL;
+
+  if(context->perf_group != NULL) {
+    perf_close(context->perf_group);
+    free(context->perf_group);
+  }
+  if(context->network_sampler != NULL) {
+    closeIfSampler(context->network_sampler);
+    free(context->network_sampler);
+  }
+  free(context->pi_history);
+
+  free(context);
+}
+
+/* The label of the context, or the MPI rank for the process context. */
+int context_label(pi_context_t *context) {
+  if(context->label >= 0)
+    return context->label;
+
+  if(context->rank < 0)
+    MPI_Comm_rank(MPI_COMM_WORLD, &context->rank);
+
+  return context->rank;
+}
+
+/* Welford's running mean and variance of the iteration time. */
+void update_pi_stats(pi_context_t *context, double value) {
+  double delta = value - context->pi_mean;
+
+  /* the history is allocated at init, iterations beyond it are only counted */
+  if(context->history_size < context->history_capacity)
+    context->pi_history[context->history_size++] = value;
+
+  context->pi_count++;
+  context->pi_mean += delta / context->pi_count;
+  context->pi_m2 += delta * (value - context->pi_mean);
+}
+
+/* Two-sided 95% Student t critical value for the mean of n samples. */
+double t_critical(unsigned int n) {
+  static const double table[] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+    2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+  };
+  unsigned int df = n - 1;
+
+  if(df <= 30)
+    return table[df - 1];
+  if(df <= 60)
+    return 2.000;
+  if(df <= 120)
+    return 1.980;
+  return 1.960;
+}
+
+/* Merges the running statistics of two sets of ranks (Chan et al.). */
+void merge_pi_stats(void *in, void *inout, int *len, MPI_Datatype *type) {
+  double *a = (double*) in, *b = (double*) inout;
+  double n, delta;
+  int i;
+
+  (void) type;
+  for(i = 0; i < *len; i++, a += STOP_FIELDS, b += STOP_FIELDS) {
+    b[STOP_FLAG] += a[STOP_FLAG];
+    n = a[STOP_COUNT] + b[STOP_COUNT];
+    if(n == 0)
+      continue;
+    delta = a[STOP_MEAN] - b[STOP_MEAN];
+    b[STOP_M2] += a[STOP_M2] + delta * delta * a[STOP_COUNT] * b[STOP_COUNT] / n;
+    b[STOP_MEAN] += delta * a[STOP_COUNT] / n;
+    b[STOP_COUNT] = n;
+  }
+}
+
+/*
+   Duplicates the world communicator at the first iteration, which every
+   rank reaches, so that no message of the stop can match one of the
+   application. Applications that only time a single rank, or initialise
+   MPI after the first iteration, cannot agree on a stop.
+*/
+bool setup_stop(pi_context_t *context) {
+  int initialized, size;
+
+  MPI_Initialized(&initialized);
+  if(!initialized) {
+    fprintf(stderr, "[PI-WARN] Convergence stop disabled: MPI is not initialized at the first iteration\n");
+    return false;
+  }
+
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+  if(single_rank && size > 1) {
+    if(context_label(context) == 0)
+      fprintf(stderr, "[PI-WARN] Convergence stop disabled: only one of %i ranks calls the iteration hooks\n", size);
+    return false;
+  }
+
+  MPI_Comm_dup(MPI_COMM_WORLD, &stop_comm);
+  MPI_Type_contiguous(STOP_FIELDS, MPI_DOUBLE, &stop_type);
+  MPI_Type_commit(&stop_type);
+  MPI_Op_create(merge_pi_stats, 1, &stop_op);
+
+  return true;
+}
+
+/*
+   Every iteration starts a non-blocking reduction of the count, mean and
+   M2 of the iteration time of every rank and completes the one of the
+   previous iteration. Rank 0 checks the 95% confidence interval of the
+   merged mean and adds its decision to the next reduction, whose sum is
+   exact, so that every rank stops at the same iteration, two after the
+   one the interval was reached in. Every rank must iterate equally often.
+*/
+bool converged(pi_context_t *context) {
+  double width = 1.e30, n;
+  int rank = context_label(context);
+
+  if(stop_comm == MPI_COMM_NULL && !setup_stop(context)) {
+    convergence_stop = false;
+    return false;
+  }
+
+  stop_local[STOP_FLAG] = 0;
+  if(stop_request != MPI_REQUEST_NULL) {
+    MPI_Wait(&stop_request, MPI_STATUS_IGNORE);
+    if(stop_global[STOP_FLAG] > 0)
+      return true;
+
+    n = stop_global[STOP_COUNT];
+    if(rank == 0 && context->pi_count >= min_iterations && n >= 2) {
+      if(stop_global[STOP_MEAN] > 0)
+        width = t_critical(n < UINT_MAX ? (unsigned int) n : UINT_MAX) *
+                sqrt(stop_global[STOP_M2] / (n - 1) / n) / stop_global[STOP_MEAN];
+      if(width <= tolerance) {
+        stop_local[STOP_FLAG] = 1;
+        printf("[PI-INFO] Converged,%i,%f,%f\n", context->current_iteration, stop_global[STOP_MEAN], width);
+      }
+    }
+  }
+
+  stop_local[STOP_COUNT] = context->pi_count;
+  stop_local[STOP_MEAN] = context->pi_mean;
+  stop_local[STOP_M2] = context->pi_m2;
+  MPI_Iallreduce(stop_local, stop_global, 1, stop_type, stop_op, stop_comm, &stop_request);
+
+  return false;
+}
+
+/* Completes the last reduction, which every rank started, before MPI_Finalize. */
+void finish_stop(pi_context_t *context) {
+  (void) context;
+
+  if(stop_comm == MPI_COMM_NULL)
+    return;
+
+  if(stop_request != MPI_REQUEST_NULL)
+    MPI_Wait(&stop_request, MPI_STATUS_IGNORE);
+  MPI_Op_free(&stop_op);
+  MPI_Type_free(&stop_type);
+  MPI_Comm_free(&stop_comm);
+  convergence_stop = false;
+}
+
 double get_current_time() {
     struct timeval tp;
     struct timezone tzp;
@@ -12,29 +324,48 @@ double get_current_time() {
     return ((double) tp.tv_sec + (double) tp.tv_usec * 1.e-6 );
 }
 
-void print_timestep(uint8_t type, double collected_time, struct rusage* resource, IFStats_t* network) {
+void print_timestep(pi_context_t *context, uint8_t type, double collected_time) {
   int rank;
+  unsigned int current_iteration = context->current_iteration;
+
+  if(output_mode == OUTPUT_TRACE) {
+    trace_timestep(context, type, collected_time);
+    return;
+  }
+
+  rank = context_label(context);
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  /* keep the lines of one context together when several threads print */
+  flockfile(stdout);
 
   switch(type) {
     case PRINT_INIT:
-      printf("[PI-INFO] Init time,%i,%f\n", rank, collected_time - init_time);
+      printf("[PI-INFO] Init time,%i,%f\n", rank, collected_time - context->init_time);
+      print_counter_names(rank, context->perf_group);
+      print_regions(rank, current_iteration);
       break;
     case PRINT_STATS:
-      printf("[PI-INFO] Paramount Iteration,%i,%i,%f,%f\n", rank, current_iteration, collected_time - init_time, pi);
-      print_resources(rank, current_iteration, resource);
-      print_network(rank, current_iteration, network);
+      printf("[PI-INFO] Paramount Iteration,%i,%i,%f,%f\n", rank, current_iteration, collected_time - context->init_time, context->pi);
+      if(context->sampler == NULL)
+        print_resources(rank, current_iteration, &context->rusage);
+      print_hardware(rank, current_iteration, context->perf_group);
+      print_network(rank, current_iteration, context->network_stats);
+      print_regions(rank, current_iteration);
       break;
     case PRINT_EXIT:
-      printf("[PI-INFO] Total time,%f\n", collected_time - init_time);
+      printf("[PI-INFO] Total time,%f\n", collected_time - context->init_time);
       break;
     case PRINT_AVG:
-      printf("[PI-INFO] PI avg,%i,%f,%d\n", rank, pi_sum/current_iteration, current_iteration);
+      printf("[PI-INFO] PI avg,%i,%f,%d\n", rank, context->pi_sum/current_iteration, current_iteration);
       break;
     case PRINT_BETA:
-      printf("[PI-INFO] Beta,%i,%f\n", rank, ((collected_time - end_time) + (begin_time - init_time))/pi_sum);
+      printf("[PI-INFO] Beta,%i,%f\n", rank, ((collected_time - context->end_time) + (context->begin_time - context->init_time))/context->pi_sum);
+      break;
+    case PRINT_PROJECTION:
+      trace_print_projection(stdout, rank, &context->prediction);
   }
+
+  funlockfile(stdout);
 }
 
 void print_resources(int rank, int current_iteration, struct rusage *stats) {
@@ -83,70 +414,498 @@ void print_network(int rank, int current_iteration, IFStats_t* stats) {
   }
 }
 
-void init_timestep_() {
-  init_time = get_current_time();
+void print_regions(int rank, int current_iteration) {
+  pi_region_t *region;
+  int i;
+
+  for(i = 0; i < pi_region_count(); i++) {
+    region = pi_region_get(i);
+    if(region->calls > 0)
+      printf("[RG-INFO] Region Stats,%i,%i,%s,%f,%llu\n", rank, current_iteration,
+             region->name, region->time, (unsigned long long) region->calls);
+  }
+}
+
+void print_counter_names(int rank, perf_group_t* group) {
+  int i;
 
-  current_iteration = 0;
-  total_time = 0;
+  if(group == NULL)
+    return;
 
-  my_rusage = (struct rusage*) malloc(sizeof(struct rusage));
+  for(i = 0; i < group->count; i++)
+    printf("[HW-INFO] Counter Name,%i,%i,%s\n", rank, i, group->names[i]);
 }
 
-void end_timestep_() {
-  end_time = get_current_time();
+void print_hardware(int rank, int current_iteration, perf_group_t* group) {
+  int i;
+
+  if(group == NULL)
+    return;
+
+  printf("[HW-INFO] Hardware Counters,%i,%i", rank, current_iteration);
+  for(i = 0; i < group->count; i++)
+    printf(",%llu", (unsigned long long) group->values[i]);
+  printf("\n");
 }
 
-void after_timestep_() {
-  begin_timestep_();
-  current_iteration--;
+/* Iterations of all the worker contexts of this process, added atomically. */
+void print_workers(pi_context_t *context) {
+  unsigned int workers = atomic_load(&worker_contexts);
+  unsigned long long iterations = atomic_load(&worker_iterations);
+
+  if(workers == 0 || iterations == 0)
+    return;
+
+  printf("[PI-INFO] Workers PI avg,%i,%f,%llu,%u\n", context_label(context),
+         atomic_load(&worker_pi_nsec) * 1.e-9 / iterations, iterations, workers);
 }
 
-void begin_timestep_() {
-  double old_begin_time = begin_time;
+/*
+   With PI_SAMPLER_PERIOD the resources and network of the process are read
+   by a thread of their own, and the iterations only record their beginning.
+*/
+void start_sampler(pi_context_t *context) {
+  context->sampler = (pi_sampler_t*) malloc(sizeof(pi_sampler_t));
+
+  if(context->sampler != NULL && pi_sampler_start(context->sampler, sampler_period, sampler_records) == 0) {
+    atexit(print_samples_at_exit);
+    return;
+  }
+
+  fprintf(stderr, "[PI-WARN] Could not start the sampler thread, sampling every iteration\n");
+  free(context->sampler);
+  context->sampler = NULL;
+}
+
+/* Stops the sampler and merges its samples with the iterations they were taken in. */
+void print_samples(pi_context_t *context) {
+  pi_sample_t sample;
+  unsigned int iteration;
+  int rank;
+
+  if(context->sampler == NULL)
+    return;
+
+  pi_sampler_stop(context->sampler);
+  rank = context_label(context);
+  trace_set_label(rank);
+
+  flockfile(stdout);
+  trace_lock();
+  while(pi_sampler_next(context->sampler, &sample, &iteration)) {
+    sample.time -= context->init_time;
+    if(output_mode == OUTPUT_TRACE)
+      trace_sample(iteration, &sample);
+    else
+      trace_print_sample(stdout, rank, iteration, &sample);
+  }
+  trace_unlock();
+  funlockfile(stdout);
+
+  if(context->sampler->dropped > 0)
+    fprintf(stderr, "[PI-WARN] Sampler of rank %i could not spill its samples, %llu dropped\n", rank, context->sampler->dropped);
+
+  pi_sampler_release(context->sampler);
+  free(context->sampler);
+  context->sampler = NULL;
+}
+
+/* Applications that never call exit_timestep_() still get their samples. */
+void print_samples_at_exit() {
+  print_samples(&process_context);
+}
+
+void report_perf_status(pi_context_t *context) {
+  if(perf_events == NULL || context->perf_group != NULL || context->worker)
+    return;
+
+  if(context_label(context) == 0)
+    fprintf(stderr, "[PI-WARN] Hardware counters disabled: %s\n",
+            perf_events_denied ? "perf events are not permitted, check /proc/sys/kernel/perf_event_paranoid"
+                               : "none of the requested events is supported");
+}
+
+/*
+   Projects the runtime of the complete run from the iterations observed.
+   The total comes from set_total_iterations_, PI_TOTAL_ITERATIONS or, for
+   applications that only know how far they got, set_progress_. When the
+   run was not stopped early its last iteration is part of the time
+   measured after the last begin_timestep_.
+*/
+bool project_runtime(pi_context_t *context, double current_time) {
+  unsigned int total = total_iterations, skipped, i;
+  double tail = 0, skipped_time = context->pi_sum;
+
+  if(total == 0 && progress > 0)
+    total = (unsigned int) (progress_iteration / progress + 0.5);
+
+  if(!context->stopped && total > 0) {
+    tail = current_time - context->begin_time;
+    total--;
+  }
+
+  /* iterations beyond the history count as observed time, not as remaining ones */
+  skipped = context->pi_count - context->history_size;
+  for(i = 0; i < context->history_size; i++)
+    skipped_time -= context->pi_history[i];
+  if(skipped > 0 && total > 0) {
+    total = total > skipped + context->history_size ? total - skipped : context->history_size;
+    tail += skipped_time;
+  }
+
+  if(pi_predict(&context->prediction, context->pi_history, context->history_size, total,
+                context->first_begin_time - context->init_time, tail) != 0)
+    return false;
+
+  if(skipped > 0) {
+    context->prediction.total += skipped;
+    context->prediction.observed += skipped;
+    context->prediction.observed_time += skipped_time;
+  }
+  if(!context->stopped)
+    context->prediction.total++;
+  context->prediction.cost_per_hour = cost_per_hour;
+
+  return true;
+}
+
+/*
+   Reduces init time, average iteration time, beta and projected runtime of every rank to
+   rank 0, which prints one [PI-SUMMARY] line per metric with the ranks
+   holding the minimum and maximum and the imbalance (max/mean - 1). Every
+   rank takes part, ranks without a timed iteration contribute nothing to
+   the minimum, maximum and mean, and the rank count only counts the others.
+*/
+void print_summary(pi_context_t *context, double current_time) {
+  static const char *names[SUMMARY_FIELDS] = {"Init time", "PI avg", "Beta", "Projected runtime"};
+  struct {
+    double value;
+    int rank;
+  } local_min[SUMMARY_FIELDS], local_max[SUMMARY_FIELDS], minimum[SUMMARY_FIELDS], maximum[SUMMARY_FIELDS];
+  double values[SUMMARY_FIELDS];
+  double sums[2 * SUMMARY_FIELDS + 1], totals[2 * SUMMARY_FIELDS + 1];
+  double mean, variance;
+  int i, size, rank = context_label(context);
+  bool timed = context->pi_count > 0;
+
+  if(timed) {
+    values[SUMMARY_INIT] = context->first_begin_time - context->init_time;
+    values[SUMMARY_AVG] = context->pi_sum/context->current_iteration;
+    values[SUMMARY_BETA] = ((current_time - context->end_time) + (context->begin_time - context->init_time))/context->pi_sum;
+    values[SUMMARY_PROJECTION] = context->projected ? context->prediction.runtime : 0;
+  }
+
+  for(i = 0; i < SUMMARY_FIELDS; i++) {
+    local_min[i].value = timed ? values[i] : DBL_MAX;
+    local_max[i].value = timed ? values[i] : -DBL_MAX;
+    local_min[i].rank = local_max[i].rank = rank;
+    sums[i] = timed ? values[i] : 0;
+    sums[SUMMARY_FIELDS + i] = timed ? values[i] * values[i] : 0;
+  }
+  sums[2 * SUMMARY_FIELDS] = timed ? 1 : 0;
+
+  MPI_Reduce(local_min, minimum, SUMMARY_FIELDS, MPI_DOUBLE_INT, MPI_MINLOC, 0, MPI_COMM_WORLD);
+  MPI_Reduce(local_max, maximum, SUMMARY_FIELDS, MPI_DOUBLE_INT, MPI_MAXLOC, 0, MPI_COMM_WORLD);
+  MPI_Reduce(sums, totals, 2 * SUMMARY_FIELDS + 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+  if(rank != 0)
+    return;
+
+  size = (int) totals[2 * SUMMARY_FIELDS];
+  if(size == 0)
+    return;
+
+  for(i = 0; i < SUMMARY_FIELDS; i++) {
+    if(i == SUMMARY_PROJECTION && maximum[i].value == 0)
+      continue;
+    mean = totals[i] / size;
+    variance = totals[SUMMARY_FIELDS + i] / size - mean * mean;
+    printf("[PI-SUMMARY] %s,%i,%f,%i,%f,%i,%f,%f,%f\n", names[i], size,
+           minimum[i].value, minimum[i].rank, maximum[i].value, maximum[i].rank,
+           mean, variance > 0 ? sqrt(variance) : 0, mean != 0 ? maximum[i].value / mean - 1 : 0);
+  }
+}
+
+void trace_timestep(pi_context_t *context, uint8_t type, double collected_time) {
+  trace_record_t *record;
+  unsigned int current_iteration = context->current_iteration;
+
+  if(!context->worker && trace_rank < 0)
+    trace_rank = context_label(context);
+
+  trace_set_label(context_label(context));
+  trace_lock();
+
+  switch(type) {
+    case PRINT_INIT:
+      record = trace_next(TRACE_INIT, current_iteration);
+      record->data.pi.time = collected_time - context->init_time;
+      if(context->perf_group != NULL)
+        trace_counter_names(context->perf_group);
+      trace_regions(current_iteration);
+      break;
+    case PRINT_STATS:
+      record = trace_next(TRACE_STATS, current_iteration);
+      record->data.pi.time = collected_time - context->init_time;
+      record->data.pi.value = context->pi;
+      if(context->sampler == NULL)
+        trace_resources(current_iteration, &context->rusage);
+      if(context->perf_group != NULL)
+        trace_hardware(current_iteration, context->perf_group);
+      if(context->network_stats != NULL)
+        trace_network(current_iteration, context->network_stats);
+      trace_regions(current_iteration);
+      break;
+    case PRINT_EXIT:
+      record = trace_next(TRACE_EXIT, current_iteration);
+      record->data.pi.time = collected_time - context->init_time;
+      break;
+    case PRINT_AVG:
+      record = trace_next(TRACE_AVG, current_iteration);
+      record->data.pi.value = context->pi_sum/current_iteration;
+      break;
+    case PRINT_BETA:
+      record = trace_next(TRACE_BETA, current_iteration);
+      record->data.pi.value = ((collected_time - context->end_time) + (context->begin_time - context->init_time))/context->pi_sum;
+      break;
+    case PRINT_PROJECTION:
+      record = trace_next(TRACE_PROJECTION, current_iteration);
+      record->data.projection = context->prediction;
+  }
+
+  trace_unlock();
+}
+
+void flush_trace(int rank) {
+  if(output_mode != OUTPUT_TRACE)
+    return;
+
+  if(trace_flush(rank, trace_dir) != 0)
+    fprintf(stderr, "[PI-WARN] Could not write trace of rank %i to %s\n", rank, trace_dir ? trace_dir : ".");
+
+  trace_release();
+  output_mode = OUTPUT_TEXT;
+}
+
+/* Applications that never call exit_timestep_() still get their trace. */
+void flush_trace_at_exit() {
+  if(trace_rank >= 0)
+    flush_trace(trace_rank);
+}
+
+void pi_init_timestep(pi_context_t *context) {
+  unsigned int capacity;
 
-  begin_time = get_current_time();
-  getrusage(RUSAGE_SELF, my_rusage);
-  IFStats_t* network_stats = getIfStats();
+  pthread_once(&settings_once, read_settings);
 
-  if(current_iteration == 0) {
-    first_begin_time = begin_time;
-    print_timestep(PRINT_INIT, begin_time, NULL, NULL);
+  context->init_time = get_current_time();
+  context->current_iteration = 0;
+  context->pi_sum = 0;
+  context->pi_count = 0;
+  context->pi_mean = 0;
+  context->pi_m2 = 0;
+  context->history_size = 0;
+  context->stopped = false;
+  context->projected = false;
+
+  /* sized from the run length when known, touched so that no page faults happen in the loop */
+  capacity = HISTORY_DEFAULT_SIZE;
+  if(early_stop && stop_in > 0)
+    capacity = stop_in;
+  else if(total_iterations > 0)
+    capacity = total_iterations < HISTORY_MAX_SIZE ? total_iterations : HISTORY_MAX_SIZE;
+  if(context->pi_history == NULL || context->history_capacity < capacity) {
+    free(context->pi_history);
+    context->pi_history = (double*) malloc(capacity * sizeof(double));
+    context->history_capacity = context->pi_history != NULL ? capacity : 0;
+  }
+  if(context->pi_history != NULL)
+    memset(context->pi_history, 0, context->history_capacity * sizeof(double));
+
+  if(context->worker)
+    atomic_fetch_add(&worker_contexts, 1);
+  else if(sampler_period > 0)
+    start_sampler(context);
+
+  if(!context->worker && context->sampler == NULL) {
+    /* The interfaces are shared by the whole process, only its context samples them */
+    context->network_sampler = (IFSampler_t*) malloc(sizeof(IFSampler_t));
+    if(context->network_sampler != NULL && openIfSampler(context->network_sampler, network_delta) != 0) {
+      free(context->network_sampler);
+      context->network_sampler = NULL;
+    }
+  }
+
+  /* perf events count the thread that opens them */
+  if(perf_events != NULL) {
+    context->perf_group = (perf_group_t*) malloc(sizeof(perf_group_t));
+    if(context->perf_group != NULL && perf_open(context->perf_group, strcmp(perf_events, "default") == 0 ? NULL : perf_events) == 0) {
+      if(context->perf_group->status == PERF_DENIED)
+        perf_events_denied = true;
+      free(context->perf_group);
+      context->perf_group = NULL;
+    }
+  }
+}
+
+void pi_end_timestep(pi_context_t *context) {
+  context->end_time = get_current_time();
+}
+
+void pi_begin_timestep(pi_context_t *context) {
+  double old_begin_time = context->begin_time;
+
+  context->begin_time = get_current_time();
+  if(context->sampler != NULL)
+    pi_sampler_mark(context->sampler, context->begin_time);
+  else
+#ifdef RUSAGE_THREAD
+    getrusage(context->worker ? RUSAGE_THREAD : RUSAGE_SELF, &context->rusage);
+#else
+    getrusage(RUSAGE_SELF, &context->rusage);
+#endif
+  if(context->perf_group != NULL)
+    perf_read(context->perf_group);
+  if(context->network_sampler != NULL) {
+    /* the sampler keeps the previous values, which must not be reported again */
+    context->network_stats = sampleIfStats(context->network_sampler);
+    if(context->network_stats == NULL) {
+      const char *error = strerror(errno);
+      fprintf(stderr, "[PI-WARN] Could not sample the network of rank %i in iteration %u: %s\n",
+              context_label(context), context->current_iteration, error);
+    }
+  }
+
+  if(context->current_iteration == 0) {
+    context->first_begin_time = context->begin_time;
+    report_perf_status(context);
+    print_timestep(context, PRINT_INIT, context->begin_time);
   }else {
-    pi = end_time - old_begin_time;
-    pi += begin_time - end_time;
-    pi_sum += pi;
+    context->pi = context->end_time - old_begin_time;
+    context->pi += context->begin_time - context->end_time;
+    context->pi_sum += context->pi;
+    update_pi_stats(context, context->pi);
 
-    print_timestep(PRINT_STATS, begin_time, my_rusage, network_stats);
+    if(context->worker) {
+      atomic_fetch_add(&worker_iterations, 1);
+      atomic_fetch_add(&worker_pi_nsec, (unsigned long long) (context->pi * 1.e9));
+    }
+
+    print_timestep(context, PRINT_STATS, context->begin_time);
   }
 
-  my_exit();
+  pi_region_reset();
+
+  my_exit(context);
 
-  current_iteration++;
+  context->current_iteration++;
 }
 
-int get_iteration_() {
-  return current_iteration;
+int pi_get_iteration(pi_context_t *context) {
+  return context->current_iteration;
 }
 
-void exit_timestep_() {
+void pi_exit_timestep(pi_context_t *context) {
   int rank;
   double current_time = get_current_time();
 
-  if(current_iteration > 0) {
-    print_timestep(PRINT_AVG, 0, NULL, NULL);
-    print_timestep(PRINT_BETA, current_time, NULL, NULL);
+  rank = context_label(context);
+
+  if(context->current_iteration > 0) {
+    context->projected = project_runtime(context, current_time);
+    if(rank_detail || context->worker) {
+      print_timestep(context, PRINT_AVG, 0);
+      print_timestep(context, PRINT_BETA, current_time);
+      if(context->projected)
+        print_timestep(context, PRINT_PROJECTION, current_time);
+    }
   }
 
-  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  /* a collective, joined also by the ranks that never iterated */
+  if(rank_summary && !context->worker)
+    print_summary(context, current_time);
+
+  if(context->worker)
+    return;
+
+  finish_stop(context);
+  print_workers(context);
+  print_samples(context);
 
   if(rank == 0)
-    print_timestep(PRINT_EXIT, current_time, NULL, NULL);
+    print_timestep(context, PRINT_EXIT, current_time);
+
+  flush_trace(rank);
 }
 
-void my_exit() {
-  if(early_stop && current_iteration == stop_in) {
-    exit_timestep_();
+/* Only the process context may end the application. */
+void my_exit(pi_context_t *context) {
+  if(context->worker)
+    return;
+
+  if((early_stop && context->current_iteration == (unsigned int) stop_in) || (convergence_stop && converged(context))) {
+    context->stopped = true;
+    pi_exit_timestep(context);
     MPI_Finalize();
     exit(0);
   }
 }
+
+/*
+   Entry points used by the applications, working on the context of the
+   calling thread. Threads sharing the process context take turns.
+*/
+
+static pi_context_t* lock_context() {
+  pi_context_t *context = pi_context_current();
+
+  if(context == &process_context)
+    pthread_mutex_lock(&process_lock);
+
+  return context;
+}
+
+static void unlock_context(pi_context_t *context) {
+  if(context == &process_context)
+    pthread_mutex_unlock(&process_lock);
+}
+
+void init_timestep_() {
+  pi_context_t *context = lock_context();
+
+  pi_init_timestep(context);
+  unlock_context(context);
+}
+
+void end_timestep_() {
+  pi_context_t *context = lock_context();
+
+  pi_end_timestep(context);
+  unlock_context(context);
+}
+
+void after_timestep_() {
+  pi_context_t *context = lock_context();
+
+  pi_begin_timestep(context);
+  context->current_iteration--;
+  unlock_context(context);
+}
+
+void begin_timestep_() {
+  pi_context_t *context = lock_context();
+
+  pi_begin_timestep(context);
+  unlock_context(context);
+}
+
+int get_iteration_() {
+  return pi_get_iteration(pi_context_current());
+}
+
+void exit_timestep_() {
+  pi_context_t *context = lock_context();
+
+  pi_exit_timestep(context);
+  unlock_context(context);
+}
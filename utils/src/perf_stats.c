@@ -0,0 +1,201 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "perf_stats.h"
+
+#define CACHE_EVENT(cache, op, result) \
+  ((cache) | ((op) << 8) | ((result) << 16))
+
+typedef struct {
+  const char *name;
+  uint32_t type;
+  uint64_t config;
+} perf_event_name_t;
+
+static const perf_event_name_t known_events[] = {
+  {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+  {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+  {"ref-cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_REF_CPU_CYCLES},
+  {"cache-references", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_REFERENCES},
+  {"cache-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+  {"branches", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_INSTRUCTIONS},
+  {"branch-misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+  {"stalled-cycles-frontend", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_FRONTEND},
+  {"stalled-cycles-backend", PERF_TYPE_HARDWARE, PERF_COUNT_HW_STALLED_CYCLES_BACKEND},
+  {"l1d-load-misses", PERF_TYPE_HW_CACHE,
+   CACHE_EVENT(PERF_COUNT_HW_CACHE_L1D, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+  {"llc-loads", PERF_TYPE_HW_CACHE,
+   CACHE_EVENT(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+  {"llc-load-misses", PERF_TYPE_HW_CACHE,
+   CACHE_EVENT(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+  {"llc-stores", PERF_TYPE_HW_CACHE,
+   CACHE_EVENT(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_WRITE, PERF_COUNT_HW_CACHE_RESULT_ACCESS)},
+  {"llc-store-misses", PERF_TYPE_HW_CACHE,
+   CACHE_EVENT(PERF_COUNT_HW_CACHE_LL, PERF_COUNT_HW_CACHE_OP_WRITE, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+  {"dtlb-load-misses", PERF_TYPE_HW_CACHE,
+   CACHE_EVENT(PERF_COUNT_HW_CACHE_DTLB, PERF_COUNT_HW_CACHE_OP_READ, PERF_COUNT_HW_CACHE_RESULT_MISS)},
+  {"page-faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+  {"context-switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+  {NULL, 0, 0}
+};
+
+static long perf_event_open(struct perf_event_attr *attr, pid_t pid, int cpu, int group_fd, unsigned long flags) {
+  return syscall(__NR_perf_event_open, attr, pid, cpu, group_fd, flags);
+}
+
+/* Accepts the names above or raw events written as r<hex>, like perf(1). */
+static int lookup_event(const char *name, uint32_t *type, uint64_t *config) {
+  int i;
+  char *end;
+
+  if(name[0] == 'r' && name[1] != '\0') {
+    *config = strtoull(name + 1, &end, 16);
+    if(*end == '\0') {
+      *type = PERF_TYPE_RAW;
+      return 0;
+    }
+  }
+
+  for(i = 0; known_events[i].name != NULL; i++) {
+    if(strcasecmp(known_events[i].name, name) == 0) {
+      *type = known_events[i].type;
+      *config = known_events[i].config;
+      return 0;
+    }
+  }
+
+  return -1;
+}
+
+static int open_event(perf_group_t *group, const char *name) {
+  struct perf_event_attr attr;
+  uint32_t type;
+  uint64_t config;
+  int fd;
+
+  if(lookup_event(name, &type, &config) != 0) {
+    fprintf(stderr, "[PI-WARN] Unknown hardware counter %s\n", name);
+    return -1;
+  }
+
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = group->leader < 0;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_ID |
+                     PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+  fd = (int) perf_event_open(&attr, 0, -1, group->leader, 0);
+  if(fd < 0) {
+    if(errno == EACCES || errno == EPERM)
+      group->status = PERF_DENIED;
+    return -1;
+  }
+
+  if(ioctl(fd, PERF_EVENT_IOC_ID, &group->ids[group->count]) != 0) {
+    close(fd);
+    return -1;
+  }
+
+  if(group->leader < 0)
+    group->leader = fd;
+
+  group->fds[group->count] = fd;
+  strncpy(group->names[group->count], name, PERF_NAME_LENGTH - 1);
+  group->names[group->count][PERF_NAME_LENGTH - 1] = '\0';
+  group->count++;
+
+  return 0;
+}
+
+/*
+   Opens the comma separated list of events as one group counting the
+   calling thread in user space. Events that the CPU does not provide are
+   skipped. Returns the number of events opened; when it is zero, status
+   tells whether perf events are not permitted or not supported.
+*/
+int perf_open(perf_group_t *group, const char *events) {
+  char list[1024];
+  char *name, *saveptr;
+
+  memset(group, 0, sizeof(perf_group_t));
+  group->leader = -1;
+  group->status = PERF_OK;
+
+  strncpy(list, events ? events : PERF_DEFAULT_EVENTS, sizeof(list) - 1);
+  list[sizeof(list) - 1] = '\0';
+
+  for(name = strtok_r(list, ", ", &saveptr); name != NULL && group->count < PERF_MAX_EVENTS;
+      name = strtok_r(NULL, ", ", &saveptr)) {
+    if(open_event(group, name) != 0 && group->status == PERF_DENIED)
+      break;
+  }
+
+  if(group->status == PERF_DENIED || group->count == 0) {
+    if(group->status != PERF_DENIED)
+      group->status = PERF_UNSUPPORTED;
+    perf_close(group);
+    return 0;
+  }
+
+  ioctl(group->leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(group->leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+
+  return group->count;
+}
+
+/*
+   Reads the whole group at once and stores in values the counts since the
+   previous read, scaled when the kernel had to multiplex the counters.
+*/
+int perf_read(perf_group_t *group) {
+  uint64_t buffer[3 + 2 * PERF_MAX_EVENTS];
+  uint64_t enabled, running, count, value;
+  uint64_t i;
+  int j;
+
+  if(group->count == 0)
+    return -1;
+
+  if(read(group->leader, buffer, sizeof(buffer)) < 0)
+    return -1;
+
+  count = buffer[0];
+  enabled = buffer[1];
+  running = buffer[2];
+
+  for(i = 0; i < count && i < PERF_MAX_EVENTS; i++) {
+    value = buffer[3 + 2 * i];
+    if(running > 0 && running < enabled)
+      value = (uint64_t) ((double) value * enabled / running);
+
+    for(j = 0; j < group->count; j++) {
+      if(group->ids[j] == buffer[4 + 2 * i]) {
+        group->values[j] = value - group->totals[j];
+        group->totals[j] = value;
+        break;
+      }
+    }
+  }
+
+  return 0;
+}
+
+void perf_close(perf_group_t *group) {
+  int i;
+
+  for(i = 0; i < group->count; i++)
+    close(group->fds[i]);
+
+  group->count = 0;
+  group->leader = -1;
+}
@@ -0,0 +1,88 @@
+#include "kernel_stats.h"
+
+/*
+   MSER-5 truncation: the iteration times are averaged in batches of
+   PREDICT_BATCH and the warm-up is the number of leading batches whose
+   removal minimizes the standard error of the remaining ones. At most half
+   of the run is considered warm-up.
+*/
+unsigned int warmup_length(const double *times, unsigned int count) {
+  unsigned int batches = count / PREDICT_BATCH, best = 0, d, i, j;
+  double sum = 0, squares = 0, mean, value, best_value = -1;
+  double *batch;
+
+  if(batches < 2)
+    return 0;
+
+  batch = (double*) malloc(batches * sizeof(double));
+  if(batch == NULL)
+    return 0;
+
+  for(i = 0; i < batches; i++) {
+    batch[i] = 0;
+    for(j = 0; j < PREDICT_BATCH; j++)
+      batch[i] += times[i * PREDICT_BATCH + j];
+    batch[i] /= PREDICT_BATCH;
+    sum += batch[i];
+    squares += batch[i] * batch[i];
+  }
+
+  for(d = 0; d <= batches / 2; d++) {
+    mean = sum / (batches - d);
+    value = (squares - (batches - d) * mean * mean) / ((double) (batches - d) * (batches - d));
+    if(best_value < 0 || value < best_value) {
+      best_value = value;
+      best = d;
+    }
+    sum -= batch[d];
+    squares -= batch[d] * batch[d];
+  }
+
+  free(batch);
+
+  return best * PREDICT_BATCH;
+}
+
+/*
+   The complete run is the init time, the observed iterations and the
+   remaining ones at the steady mean, plus tail, the time measured after
+   the last iteration. The bound is the 95% confidence interval of the
+   steady mean carried over the remaining iterations; it assumes the
+   iteration times are independent.
+   Returns -1 when the total is unknown or nothing was observed.
+*/
+int pi_predict(pi_prediction_t *prediction, const double *times, unsigned int count, unsigned int total, double init, double tail) {
+  unsigned int i, steady;
+  double sum = 0, delta, mean = 0, m2 = 0, half_width = 0, remaining;
+
+  if(total == 0 || count == 0)
+    return -1;
+
+  prediction->total = total;
+  prediction->observed = count;
+  prediction->warmup = warmup_length(times, count);
+  prediction->init = init;
+
+  for(i = 0; i < count; i++)
+    sum += times[i];
+  prediction->observed_time = init + sum;
+
+  /* Welford over the steady iterations */
+  for(i = prediction->warmup; i < count; i++) {
+    delta = times[i] - mean;
+    mean += delta / (i - prediction->warmup + 1);
+    m2 += delta * (times[i] - mean);
+  }
+  steady = count - prediction->warmup;
+  prediction->steady_mean = mean;
+
+  remaining = total > count ? total - count : 0;
+  if(steady > 1)
+    half_width = t_critical(steady) * sqrt(m2 / (steady - 1) / steady) * remaining;
+
+  prediction->runtime = prediction->observed_time + remaining * mean + tail;
+  prediction->low = prediction->runtime - half_width;
+  prediction->high = prediction->runtime + half_width;
+
+  return 0;
+}
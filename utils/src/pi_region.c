@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "pi_region.h"
+
+/* Names are shared by the process, every thread (or NAMD PE) times its own regions. */
+static char names[REGION_MAX][REGION_NAME_LENGTH];
+static atomic_int used;
+static pthread_mutex_t define_lock = PTHREAD_MUTEX_INITIALIZER;
+static __thread pi_region_t regions[REGION_MAX];
+
+/* CLOCK_MONOTONIC is served from the vDSO, unlike gettimeofday it never jumps. */
+static inline double region_time() {
+  struct timespec tp;
+
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (double) tp.tv_sec + (double) tp.tv_nsec * 1.e-9;
+}
+
+static inline int valid(int id) {
+  return id >= 0 && id < REGION_MAX;
+}
+
+/*
+   Names the region reported as id, once per process before the threads
+   time it. Only the regions up to the highest defined id are reported.
+*/
+void pi_region_define(int id, const char *name) {
+  if(!valid(id))
+    return;
+
+  pthread_mutex_lock(&define_lock);
+  strncpy(names[id], name, REGION_NAME_LENGTH - 1);
+  names[id][REGION_NAME_LENGTH - 1] = '\0';
+  if(id >= atomic_load(&used))
+    atomic_store(&used, id + 1);
+  pthread_mutex_unlock(&define_lock);
+}
+
+/*
+   Nested or interleaved entries, like several NAMD sequencer threads of one
+   PE inside runComputeObjects, are timed from the first enter to the last
+   exit, so a region never accounts for more than the elapsed time.
+*/
+void pi_region_enter(int id) {
+  if(!valid(id))
+    return;
+
+  if(regions[id].depth++ == 0)
+    regions[id].start = region_time();
+}
+
+void pi_region_exit(int id) {
+  double elapsed;
+
+  if(!valid(id) || regions[id].depth == 0)
+    return;
+
+  if(--regions[id].depth > 0)
+    return;
+
+  elapsed = region_time() - regions[id].start;
+  regions[id].time += elapsed;
+  regions[id].total += elapsed;
+  regions[id].calls++;
+}
+
+void pi_region_enter_(int *id) {
+  pi_region_enter(*id);
+}
+
+void pi_region_exit_(int *id) {
+  pi_region_exit(*id);
+}
+
+int pi_region_count() {
+  return atomic_load(&used);
+}
+
+pi_region_t* pi_region_get(int id) {
+  if(id < 0 || id >= pi_region_count())
+    return NULL;
+
+  if(names[id][0] != '\0')
+    memcpy(regions[id].name, names[id], REGION_NAME_LENGTH);
+  else
+    snprintf(regions[id].name, REGION_NAME_LENGTH, "region%d", id);
+
+  return &regions[id];
+}
+
+/* Starts a new iteration, keeping the run totals. */
+void pi_region_reset() {
+  int i, count = pi_region_count();
+
+  for(i = 0; i < count; i++) {
+    regions[i].time = 0;
+    regions[i].calls = 0;
+  }
+}
@@ -0,0 +1,255 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/time.h>
+#include <sys/resource.h>
+
+#include "pi_sampler.h"
+
+/* Same clock as get_current_time(), so samples and iterations can be merged. */
+static double sample_time() {
+  struct timeval tp;
+
+  gettimeofday(&tp, NULL);
+  return (double) tp.tv_sec + (double) tp.tv_usec * 1.e-6;
+}
+
+static int64_t status_field(const char *status, const char *name) {
+  const char *line = strstr(status, name);
+
+  if(line == NULL)
+    return 0;
+
+  return strtoll(line + strlen(name), NULL, 10);
+}
+
+static void read_status(pi_sampler_t *sampler, pi_sample_t *sample) {
+  ssize_t size;
+
+  if(sampler->status_fd < 0)
+    return;
+
+  size = pread(sampler->status_fd, sampler->buffer, SAMPLER_STATUS_SIZE - 1, 0);
+  if(size <= 0)
+    return;
+
+  sampler->buffer[size] = '\0';
+  sample->vm_size = status_field(sampler->buffer, "VmSize:");
+  sample->vm_rss = status_field(sampler->buffer, "VmRSS:");
+  sample->vm_hwm = status_field(sampler->buffer, "VmHWM:");
+}
+
+static void read_network(pi_sampler_t *sampler, pi_sample_t *sample) {
+  IFStats_t *stats;
+
+  if(!sampler->network)
+    return;
+
+  for(stats = sampleIfStats(&sampler->network_sampler); stats != NULL; stats = stats->next) {
+    sample->rx_bytes += stats->rxBytes;
+    sample->rx_packets += stats->rxPackets;
+    sample->tx_bytes += stats->txBytes;
+    sample->tx_packets += stats->txPackets;
+  }
+}
+
+/*
+   Spills the chunk to the file when it is full. Without room on disk the
+   oldest samples are kept and the newest dropped.
+*/
+static void push(pi_sampler_t *sampler, pi_sample_t *sample) {
+  size_t written;
+
+  if(sampler->count == sampler->capacity && sampler->spill != NULL) {
+    written = fwrite(sampler->samples, sizeof(pi_sample_t), sampler->count, sampler->spill);
+    memmove(sampler->samples, sampler->samples + written, (sampler->count - written) * sizeof(pi_sample_t));
+    sampler->spilled += written;
+    sampler->count -= written;
+  }
+
+  if(sampler->count == sampler->capacity) {
+    sampler->dropped++;
+    return;
+  }
+
+  sampler->samples[sampler->count++] = *sample;
+}
+
+static void* sampler_loop(void *argument) {
+  pi_sampler_t *sampler = (pi_sampler_t*) argument;
+  struct timespec next;
+  struct rusage usage;
+  pi_sample_t sample;
+
+  clock_gettime(CLOCK_MONOTONIC, &next);
+
+  while(atomic_load_explicit(&sampler->running, memory_order_acquire)) {
+    memset(&sample, 0, sizeof(sample));
+    sample.time = sample_time();
+
+    getrusage(RUSAGE_SELF, &usage);
+    sample.utime = (double) usage.ru_utime.tv_sec + (double) usage.ru_utime.tv_usec * 1.e-6;
+    sample.stime = (double) usage.ru_stime.tv_sec + (double) usage.ru_stime.tv_usec * 1.e-6;
+    sample.maxrss = usage.ru_maxrss;
+    sample.minflt = usage.ru_minflt;
+    sample.majflt = usage.ru_majflt;
+    sample.nvcsw = usage.ru_nvcsw;
+    sample.nivcsw = usage.ru_nivcsw;
+
+    read_status(sampler, &sample);
+    read_network(sampler, &sample);
+    push(sampler, &sample);
+
+    /* absolute deadlines, so the period does not drift with the sampling cost */
+    next.tv_nsec += sampler->period;
+    while(next.tv_nsec >= 1000000000L) {
+      next.tv_nsec -= 1000000000L;
+      next.tv_sec++;
+    }
+    while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL) == EINTR);
+  }
+
+  return NULL;
+}
+
+/*
+   Starts a thread taking a sample every period milliseconds. The sample
+   chunk and the first chunk of iteration marks hold capacity entries each
+   and are touched here, so that no page faults happen inside the timed loop.
+*/
+int pi_sampler_start(pi_sampler_t *sampler, double period, size_t capacity) {
+  if(period <= 0)
+    return -1;
+
+  if(capacity == 0)
+    capacity = SAMPLER_DEFAULT_RECORDS;
+
+  sampler->samples = (pi_sample_t*) malloc(capacity * sizeof(pi_sample_t));
+  sampler->marks = (pi_marks_t*) malloc(sizeof(pi_marks_t) + capacity * sizeof(double));
+  if(sampler->samples == NULL || sampler->marks == NULL) {
+    free(sampler->samples);
+    free(sampler->marks);
+    return -1;
+  }
+
+  memset(sampler->samples, 0, capacity * sizeof(pi_sample_t));
+  memset(sampler->marks, 0, sizeof(pi_marks_t) + capacity * sizeof(double));
+  sampler->capacity = capacity;
+  sampler->count = 0;
+  sampler->spill = tmpfile();
+  sampler->spilled = 0;
+  sampler->dropped = 0;
+  sampler->marks_last = sampler->marks;
+  sampler->marks_count = 0;
+  sampler->read = 0;
+  sampler->marks_read = sampler->marks;
+  sampler->marks_cursor = 0;
+  sampler->iteration = 0;
+  sampler->period = (long) (period * 1.e6);
+
+  sampler->status_fd = open("/proc/self/status", O_RDONLY);
+  sampler->network = openIfSampler(&sampler->network_sampler, false) == 0;
+
+  atomic_init(&sampler->running, 1);
+  if(pthread_create(&sampler->thread, NULL, sampler_loop, sampler) != 0) {
+    atomic_store(&sampler->running, 0);
+    pi_sampler_release(sampler);
+    return -1;
+  }
+
+  return 0;
+}
+
+/*
+   Records the beginning of an iteration. Only every capacity iterations a
+   new chunk of marks is allocated, marks without one are lost.
+*/
+void pi_sampler_mark(pi_sampler_t *sampler, double time) {
+  pi_marks_t *chunk;
+
+  if(sampler->marks_count == sampler->capacity) {
+    chunk = (pi_marks_t*) malloc(sizeof(pi_marks_t) + sampler->capacity * sizeof(double));
+    if(chunk == NULL)
+      return;
+    chunk->next = NULL;
+    sampler->marks_last->next = chunk;
+    sampler->marks_last = chunk;
+    sampler->marks_count = 0;
+  }
+
+  sampler->marks_last->times[sampler->marks_count++] = time;
+}
+
+void pi_sampler_stop(pi_sampler_t *sampler) {
+  if(!atomic_exchange(&sampler->running, 0))
+    return;
+
+  pthread_join(sampler->thread, NULL);
+}
+
+/*
+   Returns 1 with the oldest sample not read yet and the paramount iteration
+   it was taken in, that is the number of iterations begun before it, or 0
+   when all were read. Only called once the sampler has stopped.
+*/
+int pi_sampler_next(pi_sampler_t *sampler, pi_sample_t *sample, unsigned int *iteration) {
+  size_t marks;
+
+  if(sampler->read < sampler->spilled) {
+    if(sampler->read == 0)
+      rewind(sampler->spill);
+    if(fread(sample, sizeof(pi_sample_t), 1, sampler->spill) != 1)
+      return 0;
+  }else if(sampler->read < sampler->spilled + sampler->count) {
+    *sample = sampler->samples[sampler->read - sampler->spilled];
+  }else {
+    return 0;
+  }
+  sampler->read++;
+
+  for(;;) {
+    marks = sampler->marks_read == sampler->marks_last ? sampler->marks_count : sampler->capacity;
+    if(sampler->marks_cursor == marks) {
+      if(sampler->marks_read == sampler->marks_last)
+        break;
+      sampler->marks_read = sampler->marks_read->next;
+      sampler->marks_cursor = 0;
+      continue;
+    }
+    if(sampler->marks_read->times[sampler->marks_cursor] > sample->time)
+      break;
+    sampler->marks_cursor++;
+    sampler->iteration++;
+  }
+  *iteration = sampler->iteration;
+
+  return 1;
+}
+
+void pi_sampler_release(pi_sampler_t *sampler) {
+  pi_marks_t *chunk;
+
+  pi_sampler_stop(sampler);
+
+  if(sampler->status_fd >= 0)
+    close(sampler->status_fd);
+  if(sampler->network)
+    closeIfSampler(&sampler->network_sampler);
+  if(sampler->spill != NULL)
+    fclose(sampler->spill);
+
+  while(sampler->marks != NULL) {
+    chunk = sampler->marks->next;
+    free(sampler->marks);
+    sampler->marks = chunk;
+  }
+  free(sampler->samples);
+  sampler->samples = NULL;
+  sampler->marks_last = NULL;
+  sampler->spill = NULL;
+  sampler->status_fd = -1;
+  sampler->network = 0;
+}
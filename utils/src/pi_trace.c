@@ -0,0 +1,357 @@
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stdatomic.h>
+#include <pthread.h>
+
+#include "pi_trace.h"
+
+static trace_record_t *ring = NULL;
+static uint64_t ring_capacity = 0;
+static atomic_ullong ring_written = 0;
+static __thread int32_t record_label = -1;
+static pthread_mutex_t ring_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static int write_all(int fd, const void *buffer, size_t size) {
+  const char *data = (const char*) buffer;
+
+  while(size > 0) {
+    ssize_t done = write(fd, data, size);
+    if(done < 0) {
+      if(errno == EINTR)
+        continue;
+      return -1;
+    }
+    data += done;
+    size -= (size_t) done;
+  }
+
+  return 0;
+}
+
+/*
+   Allocates the ring with room for capacity records. The memory is touched
+   here so that no page faults happen inside the timed loop.
+*/
+int trace_init(size_t capacity) {
+  if(capacity == 0)
+    capacity = TRACE_DEFAULT_RECORDS;
+
+  trace_release();
+
+  ring = (trace_record_t*) malloc(capacity * sizeof(trace_record_t));
+  if(ring == NULL)
+    return -1;
+
+  memset(ring, 0, capacity * sizeof(trace_record_t));
+  ring_capacity = capacity;
+  ring_written = 0;
+
+  return 0;
+}
+
+/* Records written by the calling thread are reported with label. */
+void trace_set_label(int label) {
+  record_label = label;
+}
+
+/*
+   Writers hold the lock from the first trace_next of a group of records
+   until they are filled in, so that a thread wrapping the ring never
+   overwrites a slot another thread is still writing, nor one being flushed.
+*/
+void trace_lock() {
+  pthread_mutex_lock(&ring_lock);
+}
+
+void trace_unlock() {
+  pthread_mutex_unlock(&ring_lock);
+}
+
+/*
+   Returns the slot for the next record, to be called with the lock held.
+   When the ring is full the oldest record is overwritten.
+*/
+trace_record_t* trace_next(uint32_t type, uint32_t iteration) {
+  trace_record_t *record;
+
+  if(ring == NULL)
+    return NULL;
+
+  record = &ring[atomic_fetch_add(&ring_written, 1) % ring_capacity];
+
+  record->type = type;
+  record->iteration = iteration;
+  record->label = record_label;
+
+  return record;
+}
+
+void trace_resources(uint32_t iteration, struct rusage *stats) {
+  trace_record_t *record = trace_next(TRACE_RESOURCES, iteration);
+  int64_t *fields;
+
+  if(record == NULL)
+    return;
+
+  fields = record->data.resources.fields;
+  record->data.resources.utime = (double)stats->ru_utime.tv_sec + (double)stats->ru_utime.tv_usec*1.e-6;
+  record->data.resources.stime = (double)stats->ru_stime.tv_sec + (double)stats->ru_stime.tv_usec*1.e-6;
+  fields[0] = stats->ru_maxrss;
+  fields[1] = stats->ru_ixrss;
+  fields[2] = stats->ru_idrss;
+  fields[3] = stats->ru_isrss;
+  fields[4] = stats->ru_minflt;
+  fields[5] = stats->ru_majflt;
+  fields[6] = stats->ru_nswap;
+  fields[7] = stats->ru_inblock;
+  fields[8] = stats->ru_oublock;
+  fields[9] = stats->ru_msgsnd;
+  fields[10] = stats->ru_msgrcv;
+  fields[11] = stats->ru_nsignals;
+  fields[12] = stats->ru_nvcsw;
+  fields[13] = stats->ru_nivcsw;
+}
+
+void trace_network(uint32_t iteration, IFStats_t *stats) {
+  trace_record_t *record;
+
+  while(stats != NULL) {
+    record = trace_next(TRACE_NETWORK, iteration);
+    if(record == NULL)
+      return;
+
+    strncpy(record->data.network.device, stats->device, TRACE_DEVICE_LENGTH - 1);
+    record->data.network.device[TRACE_DEVICE_LENGTH - 1] = '\0';
+    /* rxBytes..txCompressed are laid out contiguously in IFStats_t */
+    memcpy(record->data.network.counters, &stats->rxBytes, sizeof(record->data.network.counters));
+    stats = stats->next;
+  }
+}
+
+/* The index of the counter is kept in the iteration field. */
+void trace_counter_names(perf_group_t *group) {
+  trace_record_t *record;
+  int i;
+
+  for(i = 0; i < group->count; i++) {
+    record = trace_next(TRACE_COUNTER_NAME, i);
+    if(record == NULL)
+      return;
+
+    memcpy(record->data.counter.name, group->names[i], PERF_NAME_LENGTH);
+  }
+}
+
+void trace_hardware(uint32_t iteration, perf_group_t *group) {
+  trace_record_t *record = trace_next(TRACE_HARDWARE, iteration);
+
+  if(record == NULL)
+    return;
+
+  record->data.hardware.count = group->count;
+  memcpy(record->data.hardware.values, group->values, group->count * sizeof(uint64_t));
+}
+
+void trace_regions(uint32_t iteration) {
+  trace_record_t *record;
+  pi_region_t *region;
+  int i;
+
+  for(i = 0; i < pi_region_count(); i++) {
+    region = pi_region_get(i);
+    if(region->calls == 0)
+      continue;
+
+    record = trace_next(TRACE_REGION, iteration);
+    if(record == NULL)
+      return;
+
+    memcpy(record->data.region.name, region->name, REGION_NAME_LENGTH);
+    record->data.region.time = region->time;
+    record->data.region.calls = region->calls;
+  }
+}
+
+void trace_sample(uint32_t iteration, pi_sample_t *sample) {
+  trace_record_t *record = trace_next(TRACE_SAMPLE, iteration);
+
+  if(record == NULL)
+    return;
+
+  record->data.sample = *sample;
+}
+
+/*
+   Writes the ring to <dir>/pi_trace.<rank>.bin, oldest record first.
+   Returns 0 on success and -1 on error, with errno set.
+*/
+int trace_flush(int rank, const char *dir) {
+  char path[4096];
+  trace_header_t header;
+  uint64_t first, count;
+  int fd;
+
+  if(ring == NULL)
+    return 0;
+
+  trace_lock();
+  snprintf(path, sizeof(path), "%s/pi_trace.%d.bin", dir ? dir : ".", rank);
+
+  fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(fd < 0) {
+    trace_unlock();
+    return -1;
+  }
+
+  count = ring_written < ring_capacity ? ring_written : ring_capacity;
+  first = ring_written < ring_capacity ? 0 : ring_written % ring_capacity;
+
+  memset(&header, 0, sizeof(header));
+  header.magic = TRACE_MAGIC;
+  header.version = TRACE_VERSION;
+  header.rank = rank;
+  header.record_size = sizeof(trace_record_t);
+  header.capacity = ring_capacity;
+  header.written = ring_written;
+  header.dropped = ring_written - count;
+
+  if(write_all(fd, &header, sizeof(header)) != 0 ||
+     write_all(fd, &ring[first], (count - first) * sizeof(trace_record_t)) != 0 ||
+     write_all(fd, ring, first * sizeof(trace_record_t)) != 0) {
+    int error = errno;
+    close(fd);
+    trace_unlock();
+    errno = error;
+    return -1;
+  }
+
+  trace_unlock();
+  return close(fd);
+}
+
+void trace_release() {
+  trace_lock();
+  free(ring);
+  ring = NULL;
+  ring_capacity = 0;
+  ring_written = 0;
+  trace_unlock();
+}
+
+void trace_print_sample(FILE *out, int rank, uint32_t iteration, pi_sample_t *sample) {
+  fprintf(out, "[SM-INFO] Sampler Stats,%i,%i,%f,%f,%f,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%llu,%llu,%llu,%llu\n",
+          rank, iteration, sample->time, sample->utime, sample->stime,
+          (long) sample->maxrss, (long) sample->minflt, (long) sample->majflt,
+          (long) sample->nvcsw, (long) sample->nivcsw,
+          (long) sample->vm_size, (long) sample->vm_rss, (long) sample->vm_hwm,
+          (unsigned long long) sample->rx_bytes, (unsigned long long) sample->rx_packets,
+          (unsigned long long) sample->tx_bytes, (unsigned long long) sample->tx_packets);
+}
+
+void trace_print_projection(FILE *out, int rank, pi_prediction_t *projection) {
+  double cost = projection->cost_per_hour / 3600;
+
+  fprintf(out, "[PI-INFO] Projection,%i,%u,%u,%u,%f,%f,%f,%f,%f,%f,%f\n", rank,
+          projection->total, projection->observed, projection->warmup, projection->steady_mean,
+          projection->runtime, projection->low, projection->high,
+          projection->runtime * cost, projection->low * cost, projection->high * cost);
+}
+
+/* Prints a record exactly as the text output mode would have. */
+void trace_print_record(FILE *out, int rank, trace_record_t *record) {
+  int i;
+
+  if(record->label >= 0)
+    rank = record->label;
+
+  switch(record->type) {
+    case TRACE_INIT:
+      fprintf(out, "[PI-INFO] Init time,%i,%f\n", rank, record->data.pi.time);
+      break;
+    case TRACE_STATS:
+      fprintf(out, "[PI-INFO] Paramount Iteration,%i,%i,%f,%f\n", rank, record->iteration,
+              record->data.pi.time, record->data.pi.value);
+      break;
+    case TRACE_RESOURCES:
+      fprintf(out, "[RU-INFO] Resources Stats,%i,%i,%f,%f", rank, record->iteration,
+              record->data.resources.utime, record->data.resources.stime);
+      for(i = 0; i < TRACE_RESOURCE_FIELDS; i++)
+        fprintf(out, ",%ld", (long) record->data.resources.fields[i]);
+      fprintf(out, "\n");
+      break;
+    case TRACE_NETWORK:
+      fprintf(out, "[NT-INFO] Network Stats,%i,%i,%s", rank, record->iteration,
+              record->data.network.device);
+      for(i = 0; i < TRACE_NETWORK_FIELDS; i++)
+        fprintf(out, ",%llu", (unsigned long long) record->data.network.counters[i]);
+      fprintf(out, "\n");
+      break;
+    case TRACE_COUNTER_NAME:
+      fprintf(out, "[HW-INFO] Counter Name,%i,%i,%.*s\n", rank, record->iteration,
+              PERF_NAME_LENGTH, record->data.counter.name);
+      break;
+    case TRACE_HARDWARE:
+      fprintf(out, "[HW-INFO] Hardware Counters,%i,%i", rank, record->iteration);
+      for(i = 0; i < (int) record->data.hardware.count && i < TRACE_HARDWARE_FIELDS; i++)
+        fprintf(out, ",%llu", (unsigned long long) record->data.hardware.values[i]);
+      fprintf(out, "\n");
+      break;
+    case TRACE_REGION:
+      fprintf(out, "[RG-INFO] Region Stats,%i,%i,%.*s,%f,%llu\n", rank, record->iteration,
+              REGION_NAME_LENGTH, record->data.region.name, record->data.region.time,
+              (unsigned long long) record->data.region.calls);
+      break;
+    case TRACE_SAMPLE:
+      trace_print_sample(out, rank, record->iteration, &record->data.sample);
+      break;
+    case TRACE_PROJECTION:
+      trace_print_projection(out, rank, &record->data.projection);
+      break;
+    case TRACE_AVG:
+      fprintf(out, "[PI-INFO] PI avg,%i,%f,%d\n", rank, record->data.pi.value, record->iteration);
+      break;
+    case TRACE_BETA:
+      fprintf(out, "[PI-INFO] Beta,%i,%f\n", rank, record->data.pi.value);
+      break;
+    case TRACE_EXIT:
+      fprintf(out, "[PI-INFO] Total time,%f\n", record->data.pi.time);
+      break;
+  }
+}
+
+/*
+   Reads a file produced by trace_flush and prints its records as CSV.
+   Returns the number of records dropped by the ring, or -1 on error.
+*/
+int trace_decode(const char *path, FILE *out) {
+  trace_header_t header;
+  trace_record_t record;
+  uint64_t i, count;
+  FILE *in = fopen(path, "rb");
+
+  if(in == NULL)
+    return -1;
+
+  if(fread(&header, sizeof(header), 1, in) != 1 || header.magic != TRACE_MAGIC ||
+     header.version != TRACE_VERSION || header.record_size != sizeof(trace_record_t)) {
+    fclose(in);
+    errno = EINVAL;
+    return -1;
+  }
+
+  count = header.written - header.dropped;
+  for(i = 0; i < count; i++) {
+    if(fread(&record, sizeof(record), 1, in) != 1) {
+      fclose(in);
+      errno = EIO;
+      return -1;
+    }
+    trace_print_record(out, header.rank, &record);
+  }
+
+  fclose(in);
+  return (int) header.dropped;
+}
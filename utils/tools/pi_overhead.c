@@ -0,0 +1,153 @@
+#include <mpi.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+extern void init_timestep_();
+extern void begin_timestep_();
+extern void end_timestep_();
+extern void exit_timestep_();
+
+#define DEFAULT_ITERATIONS 2000
+#define MAX_BYTES 65536
+
+/* Synthetic iteration: microseconds of arithmetic followed by an allreduce of bytes. */
+typedef struct {
+  double compute;
+  int bytes;
+} payload_t;
+
+static const payload_t payloads[] = {
+  {0, 0}, {10, 0}, {100, 0}, {1000, 0},
+  {0, 8}, {10, 8}, {100, 8}, {100, 4096}, {1000, MAX_BYTES}
+};
+
+static double send_buffer[MAX_BYTES / sizeof(double)];
+static double receive_buffer[MAX_BYTES / sizeof(double)];
+static volatile double sink;
+static double loops_per_usec;
+
+static double now() {
+  struct timespec tp;
+
+  clock_gettime(CLOCK_MONOTONIC, &tp);
+  return (double) tp.tv_sec + (double) tp.tv_nsec * 1.e-9;
+}
+
+/* A fixed amount of work, so that the instrumentation cost is not absorbed by a spin wait. */
+static void compute(long loops) {
+  double x = 1.0;
+  long i;
+
+  for(i = 0; i < loops; i++)
+    x = x * 1.0000001 + 1.e-9;
+
+  sink = x;
+}
+
+static void calibrate() {
+  long loops = 1000000;
+  double elapsed = 0;
+
+  while(elapsed < 0.05) {
+    loops *= 2;
+    elapsed = now();
+    compute(loops);
+    elapsed = now() - elapsed;
+  }
+
+  loops_per_usec = loops / (elapsed * 1.e6);
+}
+
+static void iteration(const payload_t *payload) {
+  compute((long) (payload->compute * loops_per_usec));
+
+  if(payload->bytes > 0)
+    MPI_Allreduce(send_buffer, receive_buffer, payload->bytes / sizeof(double), MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+}
+
+/* Names the configuration of the library from the same variables it reads. */
+static void mode_name(char *name, size_t size) {
+  char *output = getenv("PI_OUTPUT");
+
+  snprintf(name, size, "%s%s%s%s",
+           output != NULL && strcmp(output, "trace") == 0 ? "trace" : "text",
+           getenv("PI_SAMPLER_PERIOD") != NULL ? "+sampler" : "",
+           getenv("PI_PERF_EVENTS") != NULL ? "+perf" : "",
+           getenv("PI_NET_DELTA") != NULL ? "+delta" : "");
+}
+
+/*
+   Runs every payload without and with the timestep calls and prints on
+   stderr, apart from the output of the library, the mean over the ranks of
+   the iteration time in both cases and of the time spent inside
+   begin_timestep_ and end_timestep_, in microseconds:
+
+   [OH-INFO] Overhead,<mode>,<ranks>,<compute us>,<bytes>,<iterations>,<bare>,<instrumented>,<begin>,<end>,<max begin>
+
+   usage: mpirun -np <ranks> pi_overhead [iterations]
+   The library is configured with the usual PI_* environment variables,
+   PI_TOLERANCE and early stops must not be set.
+*/
+int main(int argc, char *argv[]) {
+  int rank, size, i, p, iterations = DEFAULT_ITERATIONS;
+  double start, begin_time, end_time, local[4], sums[4], maximum;
+  char mode[64];
+
+  if(argc > 1)
+    iterations = atoi(argv[1]);
+  if(iterations <= 0) {
+    fprintf(stderr, "usage: %s [iterations]\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  init_timestep_();
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+  calibrate();
+  mode_name(mode, sizeof(mode));
+
+  for(p = 0; p < (int) (sizeof(payloads) / sizeof(payloads[0])); p++) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = now();
+    for(i = 0; i < iterations; i++)
+      iteration(&payloads[p]);
+    local[0] = (now() - start) / iterations;
+
+    begin_time = end_time = 0;
+    MPI_Barrier(MPI_COMM_WORLD);
+    start = now();
+    for(i = 0; i < iterations; i++) {
+      double call = now();
+      begin_timestep_();
+      begin_time += now() - call;
+
+      iteration(&payloads[p]);
+
+      call = now();
+      end_timestep_();
+      end_time += now() - call;
+    }
+    local[1] = (now() - start) / iterations;
+    local[2] = begin_time / iterations;
+    local[3] = end_time / iterations;
+
+    MPI_Reduce(local, sums, 4, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&local[2], &maximum, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+
+    if(rank == 0) {
+      fprintf(stderr, "[OH-INFO] Overhead,%s,%i,%.0f,%i,%i,%f,%f,%f,%f,%f\n", mode, size,
+              payloads[p].compute, payloads[p].bytes, iterations,
+              sums[0] / size * 1.e6, sums[1] / size * 1.e6, sums[2] / size * 1.e6,
+              sums[3] / size * 1.e6, maximum * 1.e6);
+    }
+  }
+
+  exit_timestep_();
+  MPI_Finalize();
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,27 @@
+#!/bin/bash
+# Runs pi_overhead once per output and sampling mode of the PI library.
+# usage: ./tools/pi_overhead.sh [ranks] [iterations]
+# Extra mpirun options can be given in MPIRUN_FLAGS.
+
+RANKS=${1:-2}
+ITERATIONS=${2:-2000}
+BENCH=$(dirname $0)/../bin/pi_overhead
+TRACE_DIR=$(mktemp -d)
+
+MODES=(
+  ""
+  "PI_NET_DELTA=1"
+  "PI_OUTPUT=trace PI_TRACE_DIR=$TRACE_DIR"
+  "PI_SAMPLER_PERIOD=10"
+  "PI_OUTPUT=trace PI_TRACE_DIR=$TRACE_DIR PI_SAMPLER_PERIOD=10"
+  "PI_PERF_EVENTS=default"
+  "PI_OUTPUT=trace PI_TRACE_DIR=$TRACE_DIR PI_PERF_EVENTS=default"
+)
+
+echo "mode,ranks,compute_us,bytes,iterations,bare_us,instrumented_us,begin_us,end_us,max_begin_us"
+for MODE in "${MODES[@]}"
+do
+  mpirun $MPIRUN_FLAGS -np $RANKS env $MODE $BENCH $ITERATIONS 2>&1 >/dev/null | grep "\[OH-INFO\]" | cut -d, -f2-
+done
+
+rm -rf $TRACE_DIR
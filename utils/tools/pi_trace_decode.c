@@ -0,0 +1,33 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include "pi_trace.h"
+
+/*
+   Converts the per-rank files written with PI_OUTPUT=trace back into the
+   [PI-INFO]/[RU-INFO]/[NT-INFO] CSV lines of the text output mode.
+
+   usage: pi_trace_decode pi_trace.0.bin [pi_trace.1.bin ...]
+*/
+int main(int argc, char *argv[]) {
+  int i, dropped, status = EXIT_SUCCESS;
+
+  if(argc < 2) {
+    fprintf(stderr, "usage: %s pi_trace.<rank>.bin...\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  for(i = 1; i < argc; i++) {
+    dropped = trace_decode(argv[i], stdout);
+    if(dropped < 0) {
+      fprintf(stderr, "%s: %s\n", argv[i], strerror(errno));
+      status = EXIT_FAILURE;
+    }else if(dropped > 0) {
+      fprintf(stderr, "%s: %d oldest records were overwritten, increase PI_TRACE_RECORDS\n", argv[i], dropped);
+    }
+  }
+
+  return status;
+}